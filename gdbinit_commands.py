@@ -77,7 +77,8 @@ def insert_extra(args, extra):
                             if word.startswith('-') or word.startswith("'-") ],
                       default = -1)
   last_word = args[last_flag_idx].replace("'", "")
-  if last_word in ["--max-depth-per-thread", "--trace", "-m", "-t"]:
+  if last_word in ["--max-depth-per-thread", "--max-transitions", "--trace",
+                   "-m", "-M", "-t"]:
     last_flag_idx += 1
   args = args[:last_flag_idx+1] + extra.split() + args[last_flag_idx+1:]
   return ' '.join(args)
@@ -9,5 +9,9 @@ int mcprintf(const char *format, ...);
 void mcwrite(const char *str);
 void mcflush();
 bool is_redirect_stdout(bool strip_newline);
+/* Until mcprintf_stop_capture(), mcprintf() writes into `buf` instead
+ * (truncating what does not fit in `size` bytes) */
+void mcprintf_capture(char *buf, size_t size);
+void mcprintf_stop_capture();
 
 #endif /* INCLUDE_MCMINI_MCCOMMON_HPP */
@@ -3,16 +3,51 @@
 
 #include <stdint.h>
 
-#define MAX_TOTAL_THREADS_IN_PROGRAM         (20u)
-#define MAX_TOTAL_VISIBLE_OBJECTS_IN_PROGRAM (10000u)
 #define MAX_SHARED_MEMORY_ALLOCATION         (4096u)
-#define MAX_TOTAL_STATE_OBJECTS_IN_PROGRAM \
-  (MAX_TOTAL_THREADS_IN_PROGRAM +          \
-   MAX_TOTAL_VISIBLE_OBJECTS_IN_PROGRAM)
+#define SHARED_MEMORY_PAGE_SIZE              (4096ul)
 
-#define MAX_TOTAL_TRANSITIONS_IN_PROGRAM (1500)
-#define MAX_TOTAL_STATES_IN_STATE_STACK \
-  (MAX_TOTAL_TRANSITIONS_IN_PROGRAM + 1)
+/* Address space set aside for the shared memory region, which bounds
+ * the number of threads a trace can create (~1M) */
+#define MAX_SHARED_MEMORY_RESERVATION (64ul << 20)
+
+/* The number of trace processes kept forked and waiting to be handed
+ * the next branch to explore (see `mc_spawn_trace_template()`) */
+#define SPARE_TRACE_PROCESSES (1)
+
+/* The most trace processes the scheduler drives at once (see
+ * `mc_start_trace_pipeline()`) */
+#define MAX_LIVE_TRACES (4)
+
+/* How many steps beyond the earliest step not yet replayed a
+ * concurrent replay lets run (see
+ * `mc_fork_next_trace_at_current_state()`) */
+#define MC_CONCURRENT_REPLAY_WINDOW (64)
+
+/* The number of sets of semaphores in the sleep list that traces take
+ * turns using (see `trace_sleep_list_generation`): one for each live
+ * trace and one for a trace left to exit in the background */
+#define TRACE_SLEEP_LIST_GENERATIONS (MAX_LIVE_TRACES + 1)
+
+/* How far the virtual clock of a trace advances each time the trace
+ * reads it (see `MCTimeWrappers.h`) */
+#define MC_VIRTUAL_CLOCK_TICK_NS (1000ul)
+
+/* The number of bytes of the output of a trace kept for when the trace
+ * is reported (see `mc_create_trace_outputs()`) */
+#define MC_TRACE_OUTPUT_CAPACITY (64ul << 10)
+
+/* The number of threads of each trace whose nondeterministic inputs are
+ * recorded, and the room for them in each thread's log, in 8-byte words
+ * (see `MCInputWrappers.h`) */
+#define MC_INPUT_LOG_THREADS          (64)
+#define MC_INPUT_LOG_WORDS_PER_THREAD (8192)
+
+/* The number of file descriptors checked for being opened on a random
+ * device, whose reads are recorded (see `MCInputWrappers.h`) */
+#define MC_INPUT_TRACKED_FDS (1024)
+
+/* The default for `--max-transitions`; 0 there means no limit */
+#define DEFAULT_MAX_TOTAL_TRANSITIONS_IN_PROGRAM (1500)
 
 typedef uint64_t tid_t;
 typedef uint64_t mutid_t;
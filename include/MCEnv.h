@@ -2,6 +2,7 @@
 #define MC_MCENV_H
 
 #define ENV_MAX_DEPTH_PER_THREAD   "MCMINI_MAX_DEPTH_PER_THREAD"
+#define ENV_MAX_TRANSITIONS        "MCMINI_MAX_TRANSITIONS"
 #define ENV_DEBUG_AT_TRACE_ID      "MCMINI_DEBUG_AT_TRACE_ID"
 #define ENV_PRINT_AT_TRACE_ID      "MCMINI_PRINT_AT_TRACE_ID"
 #define ENV_PRINT_AT_TRACE_SEQ     "MCMINI_PRINT_AT_TRACE_SEQ"
@@ -10,5 +11,21 @@
 #define ENV_LONG_TEST              "MCMINI_LONG_TEST"
 #define ENV_QUIET                  "MCMINI_QUIET"
 #define ENV_VERBOSE                "MCMINI_VERBOSE"
+#define ENV_NO_TRACE_TEMPLATE      "MCMINI_NO_TRACE_TEMPLATE"
+#define ENV_NO_TRACE_REAPER        "MCMINI_NO_TRACE_REAPER"
+#define ENV_STEP_TIMEOUT           "MCMINI_STEP_TIMEOUT"
+#define ENV_TRACE_TIMEOUT          "MCMINI_TRACE_TIMEOUT"
+#define ENV_STEP_CPU_LIMIT         "MCMINI_STEP_CPU_LIMIT"
+#define ENV_TRACE_CPU_LIMIT        "MCMINI_TRACE_CPU_LIMIT"
+#define ENV_NO_VIRTUAL_TIME        "MCMINI_NO_VIRTUAL_TIME"
+#define ENV_NO_INPUT_REPLAY        "MCMINI_NO_INPUT_REPLAY"
+#define ENV_NO_OUTPUT_CAPTURE      "MCMINI_NO_OUTPUT_CAPTURE"
+#define ENV_LIVE_TRACES            "MCMINI_LIVE_TRACES"
+#define ENV_CONCURRENT_REPLAY      "MCMINI_CONCURRENT_REPLAY"
+#define ENV_PROFILE                "MCMINI_PROFILE"
+#define ENV_RESULTS_FD             "MCMINI_RESULTS_FD"
+#define ENV_EXPLORATION_TREE       "MCMINI_EXPLORATION_TREE"
+#define ENV_REPLAY                 "MCMINI_REPLAY"
+#define ENV_REPLAY_FILE            "MCMINI_REPLAY_FILE"
 
 #endif // MC_MCENV_H
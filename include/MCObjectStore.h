@@ -4,22 +4,30 @@
 #include "MCShared.h"
 #include "objects/MCVisibleObject.h"
 #include <memory>
-#include <string.h>
-#include <unordered_map>
+#include <stdint.h>
+#include <typeinfo>
+#include <vector>
 
+/**
+ * @brief Scrambles the bits of an address so that every bit of
+ * the result depends on every bit of the address
+ *
+ * The addresses of synchronization primitives are aligned and
+ * often allocated next to one another; used directly as hash values
+ * they leave the low bits (the ones that select a slot) nearly
+ * constant. This is the 64-bit finalizer of MurmurHash3
+ */
 struct PointerHasher {
   std::size_t
   operator()(void *code) const
   {
-    return (std::size_t)(code);
-  }
-};
-
-struct PointersEqual {
-  bool
-  operator()(void *lhs, void *rhs) const
-  {
-    return lhs == rhs;
+    uint64_t x = (uint64_t)(uintptr_t)code;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return (std::size_t)x;
   }
 };
 
@@ -32,7 +40,7 @@ class MCObjectStore {
 public:
 
   inline std::shared_ptr<MCVisibleObject> getObjectWithId(objid_t objectId) {
-    return storage[objectId]->current;
+    return storage[objectId].current;
   }
 
 private:
@@ -43,79 +51,158 @@ private:
    */
   struct StorageObject final {
     std::shared_ptr<MCVisibleObject> current;
-    const std::shared_ptr<MCVisibleObject> initialState;
+    std::shared_ptr<MCVisibleObject> initialState;
+
+    /* The 1-based position of the object among those of its type */
+    uint32_t ordinal;
 
     StorageObject(std::shared_ptr<MCVisibleObject> current,
-                  std::shared_ptr<MCVisibleObject> initialState)
-      : current(current), initialState(initialState)
+                  std::shared_ptr<MCVisibleObject> initialState,
+                  uint32_t ordinal)
+      : current(current), initialState(initialState), ordinal(ordinal)
     {}
   };
 
-  /* Points to the most recent item in the storage */
-  objid_t storageTop = -1;
-  std::shared_ptr<StorageObject>
-    storage[MAX_TOTAL_VISIBLE_OBJECTS_IN_PROGRAM];
+  /**
+   * Every object ever registered with the store, indexed by object id
+   */
+  std::vector<StorageObject> storage;
+
+  /**
+   * The number of objects of each dynamic type registered so far
+   *
+   * There are only a handful of object types, so a linear scan beats
+   * hashing the `std::type_info`
+   */
+  std::vector<std::pair<const std::type_info *, uint32_t>> typeCounts;
+
+  inline uint32_t
+  nextOrdinalForType(const std::type_info &type)
+  {
+    for (auto &typeCount : typeCounts)
+      if (*typeCount.first == type) return ++typeCount.second;
+    typeCounts.push_back({&type, 1u});
+    return 1u;
+  }
+
+  /**
+   * @brief A slot in the open-addressed table mapping system
+   * identities to object ids
+   *
+   * A slot is empty when its `shadowId` is `OBJID_EMPTY`; the system
+   * identity alone cannot mark emptiness since any address
+   * (including NULL) may legitimately be registered
+   */
+  struct SystemIdentitySlot final {
+    MCSystemID systemId;
+    objid_t shadowId;
+  };
+
+  static constexpr objid_t OBJID_EMPTY = UINT64_MAX;
 
   /**
    * Maps identities of visible objects given by the system to their
-   * shadow-struct counterparts in
+   * shadow-struct counterparts in `storage`
+   *
+   * The table uses linear probing over a power-of-two number of
+   * slots and is kept at most half full. Entries are never removed,
+   * so there are no tombstones to skip over
    */
-  std::unordered_map<MCSystemID, objid_t, PointerHasher,
-                     PointersEqual>
-    systemVisibleObjectMap;
+  std::vector<SystemIdentitySlot> systemVisibleObjectMap;
+  size_t systemVisibleObjectCount = 0;
+
+  inline size_t
+  findSlotForSystemIdentity(MCSystemID systemId) const
+  {
+    const size_t mask = systemVisibleObjectMap.size() - 1;
+    size_t i          = PointerHasher()(systemId) & mask;
+    while (systemVisibleObjectMap[i].shadowId != OBJID_EMPTY &&
+           systemVisibleObjectMap[i].systemId != systemId)
+      i = (i + 1) & mask;
+    return i;
+  }
+
+  void growSystemVisibleObjectMap();
 
   inline objid_t
   _registerNewObject(std::shared_ptr<MCVisibleObject> object)
   {
-    objid_t newObjectId = ++storageTop;
-    MC_ASSERT(newObjectId < MAX_TOTAL_VISIBLE_OBJECTS_IN_PROGRAM);
+    objid_t newObjectId     = storage.size();
     object->id              = newObjectId;
     const auto initialState = object->copy();
-    storage[newObjectId] =
-      std::make_shared<StorageObject>(object, initialState);
+    const uint32_t ordinal  = nextOrdinalForType(typeid(*object));
+    storage.emplace_back(object, initialState, ordinal);
     return newObjectId;
   }
 
 public:
 
-  // NOTE:  This cast could be done in a more complicated C++ way:
-  //        https://stackoverflow.com/questions/66368061/error-clearing-an-object-of-non-trivial-type-with-memset
-  inline MCObjectStore() { memset((void *)storage, 0, sizeof(storage)); }
-
   inline objid_t
   registerNewObject(std::shared_ptr<MCVisibleObject> object)
   {
     return this->_registerNewObject(object);
   }
 
+  /**
+   * @brief The position of the object with the given id among the
+   * objects of the same type, counting from 1 in order of registration
+   */
+  inline uint32_t
+  getOrdinalOfObjectWithId(objid_t id) const
+  {
+    return this->storage[id].ordinal;
+  }
+
   template<typename Object>
   inline std::shared_ptr<Object>
   getObjectWithId(objid_t id) const
   {
     return std::static_pointer_cast<Object, MCVisibleObject>(
-      this->storage[id]->current);
+      this->storage[id].current);
   }
 
+  /**
+   * @brief Associates the given system identity with an object
+   *
+   * As with `std::unordered_map::insert()`, an identity that is
+   * already mapped keeps its original object
+   */
   inline void
   mapSystemAddressToShadow(MCSystemID systemAddress, objid_t shadowId)
   {
-    systemVisibleObjectMap.insert({systemAddress, shadowId});
+    if (2 * (systemVisibleObjectCount + 1) > systemVisibleObjectMap.size())
+      this->growSystemVisibleObjectMap();
+
+    SystemIdentitySlot &slot =
+      systemVisibleObjectMap[findSlotForSystemIdentity(systemAddress)];
+    if (slot.shadowId == OBJID_EMPTY) {
+      slot.systemId = systemAddress;
+      slot.shadowId = shadowId;
+      systemVisibleObjectCount++;
+    }
   }
 
   template<typename Object>
   inline std::shared_ptr<Object>
   getObjectWithSystemAddress(void *systemAddress)
   {
-    auto kvPair = systemVisibleObjectMap.find(systemAddress);
+    if (systemVisibleObjectCount == 0) return nullptr;
 
-    if (kvPair != systemVisibleObjectMap.end()) {
-      objid_t shadowObjectId = kvPair->second;
-      return this->getObjectWithId<Object>(shadowObjectId);
+    const SystemIdentitySlot &slot =
+      systemVisibleObjectMap[findSlotForSystemIdentity(systemAddress)];
+    if (slot.shadowId != OBJID_EMPTY) {
+      return this->getObjectWithId<Object>(slot.shadowId);
     } else {
       return nullptr;
     }
   }
 
+  /**
+   * @brief Forgets every object in the store while keeping the
+   * memory allocated for them, so that the next trace can reuse it
+   */
+  void clear();
+
   void resetObjectsToInitialStateInStore();
 };
 
@@ -2,14 +2,15 @@
 #define INCLUDE_MCMINI_MCSHAREDTRANSITION_HPP
 
 #include "MCShared.h"
-#include "MCTransition.h"
+#include "misc/MCTypes.hpp"
+#include <type_traits>
 
 struct MCSharedTransition {
 public:
 
-  const std::type_info &type;
+  MCTransitionTypeID type;
   tid_t executor;
-  MCSharedTransition(tid_t executor, const std::type_info &type)
+  MCSharedTransition(tid_t executor, MCTransitionTypeID type)
     : type(type), executor(executor)
   {}
 };
@@ -20,10 +21,6 @@ void MCSharedTransitionReplace(MCSharedTransition *,
 static_assert(MC_IS_TRIVIALLY_COPYABLE(MCSharedTransition),
               "The shared transition is not trivially copiable. "
               "Performing a memcpy of this type "
-              "is undefined behavior according to the C++ standard. "
-              "We need to add a fallback to "
-              "writing the typeid hashcodes into shared memory and "
-              "map to types instead"
-              "This is currently unsupported at the moment");
+              "is undefined behavior according to the C++ standard.");
 
 #endif // INCLUDE_MCMINI_MCSHAREDTRANSITION_HPP
@@ -15,6 +15,7 @@ typedef MCTransition *(*MCSharedMemoryHandler)(
 #include "MCStackConfiguration.h"
 #include "MCStackItem.h"
 #include "MCThreadData.hpp"
+#include "misc/MCChunkedArray.hpp"
 #include "misc/MCSortedStack.hpp"
 #include "misc/MCTypes.hpp"
 #include "objects/MCThread.h"
@@ -81,30 +82,32 @@ private:
    * McMini to have existed at some point during
    * the execution of the program, what each thread is
    * ABOUT to execute as its next transition
+   *
+   * The per-thread tables grow as threads are created. Chunks keep
+   * the entries of consecutive threads adjacent, and entries never
+   * move, so references to a thread's data remain valid when another
+   * thread is created
    */
   tid_t nextThreadId = 0;
-  std::shared_ptr<MCTransition>
-    nextTransitions[MAX_TOTAL_THREADS_IN_PROGRAM];
+  MCChunkedArray<std::shared_ptr<MCTransition>, 6> nextTransitions;
 
   /**
    * @brief
    *
    */
-  MCThreadData threadData[MAX_TOTAL_THREADS_IN_PROGRAM];
+  MCChunkedArray<MCThreadData, 6> threadData;
 
   /**
    * A pointer to the top-most element in the transition stack
    */
   int transitionStackTop = -1;
-  std::shared_ptr<MCTransition>
-    transitionStack[MAX_TOTAL_TRANSITIONS_IN_PROGRAM];
+  MCChunkedArray<std::shared_ptr<MCTransition>> transitionStack;
 
   /**
    * A pointer to the top-most element in the state stack
    */
   int stateStackTop = -1;
-  std::shared_ptr<MCStackItem>
-    stateStack[MAX_TOTAL_STATES_IN_STATE_STACK];
+  MCChunkedArray<std::shared_ptr<MCStackItem>> stateStack;
 
   /**
    * @brief Associates a handler function that McMini
@@ -116,10 +119,11 @@ private:
    * to tell McMini how data written by each wrapper function
    * should be processed to create the corresponding objects
    * mcMini knows how to handle
+   *
+   * The table is indexed directly by the `MCTransitionTypeID`
+   * written into the shared memory mailbox
    */
-  std::unordered_map<TypeInfoRef, MCSharedMemoryHandler, TypeHasher,
-                     TypesEqual>
-    sharedMemoryHandlerTypeMap;
+  std::vector<MCSharedMemoryHandler> sharedMemoryHandlers;
 
   /**
    * @brief Maps thread ids to their respective object ids
@@ -355,7 +359,7 @@ private:
    * @param i the index in the transition stack to which the returned
    * clock vector correpsonds
    */
-  MCClockVector clockVectorForTransitionAtIndex(int i) const;
+  const MCClockVector &clockVectorForTransitionAtIndex(int i) const;
 
   /**
    * Inserts a backtrack point given a context of insertion (where
@@ -435,6 +439,21 @@ public:
    */
   std::vector<tid_t> getThreadIdBacktrace() const;
 
+  /**
+   * @brief Computes, for each thread other than the one which executed
+   * the transition at the given index in the transition stack, the
+   * index of the last transition of that thread which happens before
+   * it (if there is one)
+   *
+   * Together with the transitions preceding it in its own thread, these
+   * are the transitions which must have been executed before the given
+   * one can be: any other transition before it in the stack is
+   * independent of it
+   *
+   * @return the indices, in no particular order
+   */
+  std::vector<int> getCausalPredecessorsOfTransitionAtIndex(int i) const;
+
   // MARK: State stack
 
   MCStackItem &getStateItemAtIndex(int) const;
@@ -521,6 +540,12 @@ public:
     return objectStorage.getObjectWithId<Object>(id);
   }
 
+  uint32_t
+  getOrdinalOfObjectWithId(objid_t id) const
+  {
+    return objectStorage.getOrdinalOfObjectWithId(id);
+  }
+
   template<typename Object>
   std::shared_ptr<Object>
   getVisibleObjectWithSystemIdentity(MCSystemID systemId)
@@ -533,7 +558,21 @@ public:
   // about what we need. Most of the logic itself ca (and should) stay
   // relatively in-tact, but the organization needs to be improved
   // greatly
-  void registerVisibleOperationType(MCType, MCSharedMemoryHandler);
+  template<typename Transition>
+  void
+  registerVisibleOperationType(MCSharedMemoryHandler handler)
+  {
+    this->registerVisibleOperationType(
+      MCTransitionType<Transition>::id, handler);
+  }
+
+  /**
+   * @brief Installs the handler for the transition type with the
+   * given id, first assigning the next available id to the type if
+   * it has not yet been registered
+   */
+  void registerVisibleOperationType(MCTransitionTypeID &,
+                                    MCSharedMemoryHandler);
   void registerVisibleObjectWithSystemIdentity(
     MCSystemID, std::shared_ptr<MCVisibleObject>);
 
@@ -543,6 +582,19 @@ public:
   // things
   void simulateRunningTransition(const MCTransition &,
                                  MCSharedTransition *, void *);
+
+  /**
+   * @brief Updates the model with a transition the trace just ran, as
+   * `simulateRunningTransition()` does, but without the bookkeeping of
+   * DPOR (clock vectors, sleep sets and the threads enabled in each
+   * state)
+   *
+   * Meant for replaying a schedule given in full (see
+   * `mc_replay_schedule()`), after which there is nothing to backtrack
+   * to
+   */
+  void replayRunningTransition(const MCTransition &,
+                               MCSharedTransition *, void *);
   void dynamicallyUpdateBacktrackSets();
 
   bool isInDeadlock() const;
@@ -11,6 +11,12 @@
 #define MC_STATE_CONFIG_THREAD_NO_LIMIT (UINT64_MAX)
 #define MC_STATE_CONFIG_PRINT_AT_TRACE  (UINT64_MAX)
 
+/**
+ * A configuration constant which specifies that a trace
+ * may contain any number of transitions
+ */
+#define MC_STATE_CONFIG_TRANSITIONS_NO_LIMIT (UINT64_MAX)
+
 /**
  * A struct which describes the configurable parameters
  * of the model checking execution
@@ -23,6 +29,12 @@ struct MCStackConfiguration final {
    */
   const uint64_t maxThreadExecutionDepth;
 
+  /**
+   * The maximum number of transitions that may be run
+   * in any single trace before McMini gives up
+   */
+  const uint64_t maxTotalTransitions;
+
   /**
    * The trace id to stop the model checker at
    * to print the contents of the transition stack.
@@ -43,10 +55,12 @@ struct MCStackConfiguration final {
   const bool expectForwardProgressOfThreads;
 
   MCStackConfiguration(uint64_t maxThreadExecutionDepth,
+                       uint64_t maxTotalTransitions,
                        trid_t printBacktraceAtTraceNumber,
                        bool firstDeadlock,
                        bool expectForwardProgressOfThreads)
     : maxThreadExecutionDepth(maxThreadExecutionDepth),
+      maxTotalTransitions(maxTotalTransitions),
       printBacktraceAtTraceNumber(printBacktraceAtTraceNumber),
       expectForwardProgressOfThreads(expectForwardProgressOfThreads)
   {}
@@ -181,9 +181,9 @@ public:
   void
   markThreadsEnabledInState(const std::unordered_set<tid_t> &threads);
 
-  MCClockVector getClockVector() const;
-  std::unordered_set<tid_t> getEnabledThreadsInState() const;
-  std::unordered_set<tid_t> getSleepSet() const;
+  const MCClockVector &getClockVector() const;
+  const std::unordered_set<tid_t> &getEnabledThreadsInState() const;
+  const std::unordered_set<tid_t> &getSleepSet() const;
 
   /**
    * @brief Inserts the given thread into the sleep
@@ -201,6 +201,12 @@ public:
    */
   bool hasThreadsToBacktrackOn() const;
 
+  /**
+   * @brief The number of threads left in the
+   * backtracking set of this state
+   */
+  size_t getBacktrackSetSize() const;
+
   /**
    * @brief Whether or not the given thread
    * is contained in the backtracking set of this
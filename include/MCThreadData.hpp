@@ -17,7 +17,7 @@ struct MCThreadData final {
   void incrementExecutionDepth();
   void decrementExecutionDepthIfNecessary();
 
-  MCClockVector getClockVector() const;
+  const MCClockVector &getClockVector() const;
   void setClockVector(const MCClockVector &);
 
   // FIXME: We can probably remove execution points
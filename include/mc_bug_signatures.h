@@ -0,0 +1,51 @@
+#ifndef INCLUDE_MCMINI_MC_BUG_SIGNATURES_H
+#define INCLUDE_MCMINI_MC_BUG_SIGNATURES_H
+
+#include "MCConstants.h"
+
+/**
+ * @brief Tells a bug found in the current trace apart from the bugs
+ * found in earlier traces
+ *
+ * Many traces usually run into the same bug, each along a schedule of
+ * its own. A bug is known by its signature: its kind, and for each
+ * thread involved, the operation the thread is stuck at (or races on)
+ * and the last operation it ran, by type and object ordinal (addresses,
+ * as of shared variables, by the order they were first seen) but not by
+ * thread id. The threads involved are all live threads for a deadlock,
+ * the thread at fault for a livelock, and the thread at fault together
+ * with the threads it races with for a data race.
+ *
+ * Only the first trace running into a bug need be reported in full;
+ * the others are counted (see `mc_print_distinct_bugs()`)
+ *
+ * @param kind the kind of bug, as it is named in the stream of results
+ * (see `mc_open_result_stream()`)
+ * @param tid the thread at fault, or `TID_INVALID` if the bug is not
+ * that of one thread
+ * @param isNew set to whether no earlier trace ran into the bug
+ * @return the number of the bug, counting from 1 in the order in which
+ * bugs are first found
+ */
+unsigned mc_classify_bug(const char *kind, tid_t tid, bool *isNew);
+
+/**
+ * @brief A hash of the signature of the bug with the given number
+ *
+ * Two runs of McMini, on different schedules of the same target, ran
+ * into the same bug when the hashes of their bugs match
+ */
+uint64_t mc_bug_signature_hash(unsigned bugId);
+
+/**
+ * @brief The number of distinct bugs found so far
+ */
+unsigned mc_distinct_bug_count();
+
+/**
+ * @brief Prints each distinct bug with the first trace which ran into it
+ * and the number of traces which did
+ */
+void mc_print_distinct_bugs();
+
+#endif // INCLUDE_MCMINI_MC_BUG_SIGNATURES_H
@@ -0,0 +1,68 @@
+#ifndef INCLUDE_MCMINI_MC_EXPLORATION_TREE_H
+#define INCLUDE_MCMINI_MC_EXPLORATION_TREE_H
+
+#include "MCConstants.h"
+#include "mc_scheduler_profile.h"
+#include <stdint.h>
+
+/**
+ * @brief Opens the file named by the environment variable
+ * `MCMINI_EXPLORATION_TREE` (`--exploration-tree`), if set, to write the
+ * tree DPOR explores into
+ *
+ * Each trace runs from the initial state through the state it branches
+ * off from the traces before it, so that the traces make up a tree. The
+ * tree is written out one branch point (a state from which more than
+ * one thread was run) at a time, once everything beneath it has been
+ * explored; chains of states without branches are folded into the
+ * branches leading through them. The initial state comes last. Each
+ * branch point is given with:
+ *
+ *  - its depth, the number of threads enabled and asleep when it was
+ *    first reached, and the most threads DPOR had left to run from it
+ *    when one of them was taken
+ *  - each branch out of it, in the order explored: the thread run, the
+ *    next branch point down the branch (if any), and the traces,
+ *    transitions and time beneath the branch
+ *  - the traces, transitions and time beneath it, the latter split by
+ *    phase of the scheduler (see `mc_scheduler_phase`), and the time
+ *    spent forking and replaying traces back to it
+ *
+ * A few branch points with many traces beneath them, or whose replays
+ * take long, are where restructuring the target or tightening bounds
+ * pays. The time of a trace is that the scheduler spends from the moment
+ * it branches off until the next trace does. The file is in DOT if its
+ * name ends in ".dot", and otherwise holds a JSON object per branch
+ * point and line (JSON Lines).
+ *
+ * Without the variable set, every other function here does nothing
+ */
+void mc_open_exploration_tree();
+
+/**
+ * @brief Notes that the scheduler starts on a trace which branches off
+ * from the state at the given depth by running the given thread
+ *
+ * Everything beneath the deeper states of the trace before is then
+ * explored: they are written out
+ */
+void mc_exploration_tree_begin_trace(int branchPoint, tid_t tid);
+
+/**
+ * @brief Notes that the current trace is done, with the transitions on
+ * the transition stack
+ */
+void mc_exploration_tree_end_trace();
+
+/**
+ * @brief Counts the time of a phase toward the current trace
+ */
+void mc_exploration_tree_add_time(mc_scheduler_phase phase, uint64_t ns);
+
+/**
+ * @brief Writes out the branch points left, up to the initial state, and
+ * closes the file
+ */
+void mc_close_exploration_tree();
+
+#endif // INCLUDE_MCMINI_MC_EXPLORATION_TREE_H
@@ -0,0 +1,65 @@
+#ifndef INCLUDE_MCMINI_MC_RESULT_STREAM_H
+#define INCLUDE_MCMINI_MC_RESULT_STREAM_H
+
+#include "MCConstants.h"
+
+/**
+ * @brief Opens the stream of results on the file descriptor given by the
+ * environment variable `MCMINI_RESULTS_FD` (`--results-fd`), if set
+ *
+ * Besides its output for people, McMini then writes what it finds as it
+ * goes to the descriptor, one JSON object per line (JSON Lines), each
+ * with an "event" member telling what it is about:
+ *
+ *  - "trace": how a trace ended ("outcome" is one of "ok", "deadlock",
+ *    "livelock", "crash", "diverged" and "limit"), with its number of
+ *    transitions, the bugs found in it and how long it took
+ *  - "bug": a bug found in a trace ("kind" is one of "deadlock",
+ *    "data_race", "livelock" and "crash"), with the number of the
+ *    distinct bug it is (see `mc_classify_bug()`) and the hash of its
+ *    signature (see `mc_bug_signature_hash()`); the first time the bug
+ *    is found ("new" is true), also with the schedule of the trace, its
+ *    transitions and the operation each thread is at
+ *  - "progress": the number of traces and transitions so far, whenever
+ *    McMini tells how far it has got
+ *  - "summary": the totals once McMini is done, with the peak resident
+ *    set size (in kB) of the scheduler and of the largest trace
+ *
+ * Times are in microseconds since the scheduler started. Without the
+ * variable set, nothing is written and every other function here does
+ * nothing
+ */
+void mc_open_result_stream();
+
+/**
+ * @brief Notes that the scheduler starts on a new trace
+ */
+void mc_stream_trace_start();
+
+/**
+ * @brief Writes out how the current trace ended
+ */
+void mc_stream_trace_outcome(const char *outcome);
+
+/**
+ * @brief Writes out a bug found in the current trace
+ *
+ * @param tid the thread at fault, or `TID_INVALID` if the bug is not
+ * that of one thread
+ * @param bugId the number of the bug (see `mc_classify_bug()`)
+ * @param isNew whether no earlier trace ran into the bug
+ */
+void mc_stream_bug(const char *kind, tid_t tid, unsigned bugId, bool isNew);
+
+/**
+ * @brief Writes out how many traces and transitions McMini has gone
+ * through so far
+ */
+void mc_stream_progress();
+
+/**
+ * @brief Writes out the totals of the run
+ */
+void mc_stream_summary(uint64_t tracesOverBudget, uint64_t tracesDiverged);
+
+#endif // INCLUDE_MCMINI_MC_RESULT_STREAM_H
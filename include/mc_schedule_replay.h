@@ -0,0 +1,33 @@
+#ifndef INCLUDE_MCMINI_MC_SCHEDULE_REPLAY_H
+#define INCLUDE_MCMINI_MC_SCHEDULE_REPLAY_H
+
+/**
+ * @brief Whether McMini is to replay a schedule given by the environment
+ * variable `MCMINI_REPLAY` (`--replay`) or `MCMINI_REPLAY_FILE`
+ * (`--replay-file`) rather than search the state space of the target
+ */
+bool mc_schedule_to_replay_given();
+
+/**
+ * @brief Runs one trace of the target along the given schedule, then
+ * exits McMini
+ *
+ * The schedule is a list of thread ids, separated by commas or spaces,
+ * one for each transition of the trace, as with '-t <traceSeq>';
+ * `MCMINI_REPLAY` holds the list itself and `MCMINI_REPLAY_FILE` names
+ * a file holding it, of any length. The file may instead hold a THREAD
+ * BACKTRACE as McMini prints it (e.g. copied from the report of a bug),
+ * in which case each step is also checked to run the same operation
+ * ("thread 1: pthread_mutex_lock(mut:2)") as in the backtrace.
+ *
+ * Unlike '-t', the trace is driven directly: the scheduler keeps no
+ * clock vectors, sleep sets or backtrack sets, nor looks for data races,
+ * since no other trace follows. The replay stops, reporting where, at
+ * the first step naming a thread which cannot run or which is at a
+ * different operation than expected. Once the schedule is used up, the
+ * transitions of the trace and the operation each thread is at are
+ * printed, with a deadlock reported if the threads are in one
+ */
+void mc_replay_schedule();
+
+#endif // INCLUDE_MCMINI_MC_SCHEDULE_REPLAY_H
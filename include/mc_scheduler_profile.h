@@ -0,0 +1,61 @@
+#ifndef INCLUDE_MCMINI_MC_SCHEDULER_PROFILE_H
+#define INCLUDE_MCMINI_MC_SCHEDULER_PROFILE_H
+
+#include <stdint.h>
+
+/*
+ * The phases of the scheduler's work which are timed
+ */
+enum mc_scheduler_phase {
+  MC_PHASE_FORK,      // Forking a trace (see `mc_fork_trace_process()`)
+  MC_PHASE_REPLAY,    // Replaying the transitions leading up to a branch
+  MC_PHASE_STEP,      // Running a thread of the target during the search
+  MC_PHASE_SIMULATE,  // `MCStack::simulateRunningTransition()`
+  MC_PHASE_BACKTRACK, // `MCStack::dynamicallyUpdateBacktrackSets()`
+  MC_PHASE_CHECKS,    // Looking for data races and deadlocks
+  MC_PHASE_TEARDOWN,  // Terminating a trace
+  MC_PHASE_COUNT
+};
+
+/**
+ * @brief Starts timing the phases of the scheduler if the environment
+ * variable `MCMINI_PROFILE` (`--profile`) is set
+ *
+ * Each time the scheduler goes through a phase, the time it takes is
+ * added to the total of the phase and counted in a histogram of the
+ * phase with a bucket per power of two of nanoseconds. The breakdown
+ * (see `mc_print_scheduler_profile()`) tells whether a slow run is
+ * dominated by the target, by replaying traces, or by the bookkeeping
+ * of DPOR. When `MCMINI_PROFILE` holds some N > 0, the breakdown is also
+ * printed every N seconds or so.
+ *
+ * Otherwise, nothing is timed, unless for the exploration tree (see
+ * `mc_open_exploration_tree()`): `mc_begin_phase()` and `mc_end_phase()`
+ * return right away
+ */
+void mc_start_scheduler_profile();
+
+/**
+ * @brief Notes the time at which a phase begins
+ *
+ * @return the time to hand to `mc_end_phase()` once the phase is over
+ */
+uint64_t mc_begin_phase();
+
+/**
+ * @brief Adds the time since `begin` to the given phase
+ */
+void mc_end_phase(mc_scheduler_phase phase, uint64_t begin);
+
+/**
+ * @brief The name of the phase, as the profile shows it
+ */
+const char *mc_scheduler_phase_name(mc_scheduler_phase phase);
+
+/**
+ * @brief Prints the time spent in each phase so far, if the phases are
+ * timed
+ */
+void mc_print_scheduler_profile();
+
+#endif // INCLUDE_MCMINI_MC_SCHEDULER_PROFILE_H
@@ -3,6 +3,7 @@
 
 #include "MCShared.h"
 #include <semaphore.h>
+#include <stdint.h>
 
 // NOTE: We have a semaphore pair for each thread.  trace_sleep_list
 //       is an array of mc_shared_sem (no relation to sleep sets).
@@ -18,6 +19,13 @@
 struct mc_shared_sem {
   sem_t dpor_scheduler_sem; // scheduler waits on this; target posts
   sem_t pthread_sem; // target waits on this; scheduler posts
+
+  // The visible operation Thread X reached last: its type and the first
+  // word of its payload, mostly the address of the object it operates on
+  // (see `mc_reached_objects`). Unlike the mailbox, which all threads of
+  // a trace write to, this stays put while other threads run
+  uint64_t reached_type;
+  uint64_t reached_object;
 };
 typedef struct mc_shared_sem *mc_shared_sem_ref;
 
@@ -25,6 +33,11 @@ void mc_shared_sem_init(mc_shared_sem_ref);
 void mc_shared_sem_destroy(mc_shared_sem_ref);
 
 void mc_shared_sem_wait_for_thread(mc_shared_sem_ref);
+
+/* As mc_shared_sem_wait_for_thread(), but gives up at the given time
+ * of CLOCK_MONOTONIC. Returns 0, or -1 with errno ETIMEDOUT */
+int mc_shared_sem_wait_for_thread_until(mc_shared_sem_ref,
+                                        const struct timespec *deadline);
 void mc_shared_sem_wait_for_scheduler(mc_shared_sem_ref);
 void mc_shared_sem_wake_thread(mc_shared_sem_ref);
 void mc_shared_sem_wake_scheduler(mc_shared_sem_ref);
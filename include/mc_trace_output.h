@@ -0,0 +1,54 @@
+#ifndef INCLUDE_MCMINI_MC_TRACE_OUTPUT_H
+#define INCLUDE_MCMINI_MC_TRACE_OUTPUT_H
+
+/**
+ * @brief Creates the buffers the traces write their output into
+ *
+ * Rather than to the terminal, where the output of every trace would
+ * be interleaved with McMini's own (and writing to which can block a
+ * trace on a slow pipe), each trace writes its standard output and
+ * standard error into an in-memory file (see memfd_create(2)). The
+ * output of a trace is only shown if McMini reports a problem with the
+ * trace (see `mc_print_trace_output()`), and otherwise discarded.
+ *
+ * Like the semaphores of the sleep list, each generation of the list
+ * has its own buffer (see `trace_sleep_list_generation`) so that a
+ * trace still tearing itself down cannot write into the buffer of the
+ * next one, nor two live traces into the same buffer. Only the last
+ * `MC_TRACE_OUTPUT_CAPACITY` bytes written by a trace are kept.
+ *
+ * The output of traces is not captured when the environment variable
+ * `MCMINI_NO_OUTPUT_CAPTURE` is set, nor with `--quiet`, which discards
+ * it
+ */
+void mc_create_trace_outputs();
+
+/**
+ * @brief Redirects the standard output and error of the calling trace
+ * into the buffer of its generation of the sleep list
+ */
+void mc_capture_trace_output();
+
+/**
+ * @brief Empties the buffer of the given generation of the sleep list
+ * before it is handed to a new trace
+ *
+ * The last trace to use the buffer must have exited
+ */
+void mc_reset_trace_output(unsigned generation);
+
+/**
+ * @brief Frees what the current trace wrote before the output it is
+ * to keep
+ *
+ * Meant to be called after each step of the trace: the buffer is only
+ * looked at every so often
+ */
+void mc_trim_trace_output();
+
+/**
+ * @brief Prints the output of the current trace
+ */
+void mc_print_trace_output();
+
+#endif // INCLUDE_MCMINI_MC_TRACE_OUTPUT_H
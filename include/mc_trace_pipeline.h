@@ -0,0 +1,55 @@
+#ifndef INCLUDE_MCMINI_MC_TRACE_PIPELINE_H
+#define INCLUDE_MCMINI_MC_TRACE_PIPELINE_H
+
+/**
+ * @brief Starts the threads in the scheduler which replay branches in
+ * traces of their own ahead of time
+ *
+ * Exploring a branch starts with replaying, in a new trace, the
+ * transitions leading up to its branch point, during which the
+ * scheduler only waits on the trace. Branch points are explored
+ * deepest first, so the transitions leading up to a pending branch
+ * point no deeper than the one being explored stay as they are until
+ * that branch point is explored in turn: a trace can be brought there
+ * while the scheduler explores with the current one.
+ *
+ * With the environment variable `MCMINI_LIVE_TRACES` (`--live-traces`)
+ * set to some K > 1 (at most `MAX_LIVE_TRACES`), the scheduler keeps up
+ * to K - 1 such traces besides the current one, each replayed by a
+ * thread of its own on a generation of the sleep list of its own, so
+ * that replays run on other cores. When exploration reaches a branch
+ * point replayed ahead of time, the trace waiting there becomes the
+ * current trace (see `mc_adopt_prepared_trace()`). Each step replayed
+ * is checked against the step as first run (see
+ * `mc_record_step_checksum()`): a trace which goes another way, or
+ * which exits, is terminated and its branch replayed as it would have
+ * been without pipelining. Either way, the branches are explored, and
+ * results reported, in the same order as with a single live trace.
+ *
+ * Pipelining is off without the reaper (see `mc_start_trace_reaper()`),
+ * with time budgets set for traces, and when a trace sequence is given
+ * with `--trace`, in which case this function does nothing
+ */
+void mc_start_trace_pipeline();
+
+/**
+ * @brief Makes the trace replayed ahead of time up to the given branch
+ * point, if there is one, the current trace, waiting for its replay to
+ * complete
+ *
+ * The transition stack must be that of the branch point, as it is when
+ * the scheduler is about to replay the branch
+ *
+ * @return whether the trace was adopted; otherwise, the scheduler must
+ * replay the branch itself
+ */
+bool mc_adopt_prepared_trace(int branchPoint);
+
+/**
+ * @brief Starts replaying traces ahead of time up to the deepest
+ * pending branch points no deeper than the given one, as many as there
+ * are threads free to replay them
+ */
+void mc_prepare_traces_ahead(int branchPoint);
+
+#endif // INCLUDE_MCMINI_MC_TRACE_PIPELINE_H
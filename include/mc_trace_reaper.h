@@ -0,0 +1,91 @@
+#ifndef INCLUDE_MCMINI_MC_TRACE_REAPER_H
+#define INCLUDE_MCMINI_MC_TRACE_REAPER_H
+
+#include "MCConstants.h"
+#include <sys/types.h>
+
+/**
+ * @brief Starts the thread in the scheduler that supervises the trace
+ * the scheduler runs and collects the traces it has terminated
+ *
+ * A trace asked to exit still has to tear down its address space
+ * before `waitpid()` returns, which for targets with large address
+ * spaces takes milliseconds. The scheduler need not sit through it:
+ * it hands each terminated trace to the reaper and goes on forking
+ * and replaying the next one. The reaper watches the traces handed
+ * to it through pidfds on an epoll set and reaps each as soon as it
+ * has exited.
+ *
+ * The reaper watches the trace the scheduler is running in the same
+ * way. Should that trace exit without the scheduler having asked it
+ * to (e.g. on a segfault or a failed assertion), the reaper wakes the
+ * scheduler (see `mc_notify_trace_stopped_early()`), which reports the
+ * failure instead of waiting forever on a thread that is gone.
+ *
+ * The reaper is not used when the environment variable
+ * `MCMINI_NO_TRACE_REAPER` is set (as McMini's GDB scripts do, since
+ * they expect the scheduler to be single-threaded and to wait for each
+ * trace in `mc_terminate_trace()`) or if the kernel does not support
+ * pidfds, in which case this function does nothing
+ *
+ * @return whether the reaper was started
+ */
+bool mc_start_trace_reaper();
+
+/**
+ * @brief Has the reaper watch the trace the scheduler has just
+ * forked for an early exit
+ */
+void mc_supervise_trace(pid_t pid, trid_t id);
+
+/**
+ * @brief Hands a trace about to be asked to exit over to the reaper
+ *
+ * If the trace exits abnormally, the reaper reports it (in verbose
+ * mode) under the given trace id, which the scheduler will likely
+ * have moved past by then.
+ *
+ * @return a pidfd for the trace, to be passed to
+ * `mc_await_trace_exit()`, or -1 if there is no reaper, in which case
+ * the scheduler must wait for the trace itself
+ */
+int mc_reap_trace_in_background(pid_t pid, trid_t id);
+
+/**
+ * @brief Has the reaper collect the trace the scheduler is running
+ * without reporting its exit, for the scheduler to kill it on its way
+ * out
+ *
+ * Unlike `mc_reap_trace_in_background()`, this function is
+ * async-signal-safe: it neither allocates nor touches the epoll set
+ *
+ * @return whether the reaper was supervising the trace and will
+ * collect it; if not, the scheduler must wait for the trace itself
+ */
+bool mc_expect_supervised_trace_exit();
+
+/**
+ * @brief Blocks until a trace handed to the reaper has exited and
+ * closes the pidfd returned for it by `mc_reap_trace_in_background()`
+ *
+ * Once this function returns, no thread of the trace can touch memory
+ * it shared with the scheduler (the trace may not yet be reaped)
+ */
+void mc_await_trace_exit(int pidfd);
+
+/**
+ * @brief Gives the reaper a moment to collect (and report on) the
+ * traces handed to it before the scheduler exits
+ *
+ * The scheduler sleeps until the reaper has collected the last trace
+ * or for at most a second. This function is async-signal-safe
+ */
+void mc_drain_trace_reaper();
+
+/**
+ * @brief Opens a pidfd for the process with the given id, returning -1
+ * if the process is gone or the kernel does not support pidfds
+ */
+int mc_pidfd_open(pid_t pid);
+
+#endif // INCLUDE_MCMINI_MC_TRACE_REAPER_H
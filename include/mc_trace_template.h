@@ -0,0 +1,58 @@
+#ifndef INCLUDE_MCMINI_MC_TRACE_TEMPLATE_H
+#define INCLUDE_MCMINI_MC_TRACE_TEMPLATE_H
+
+#include <sys/types.h>
+
+/**
+ * @brief Forks the template process from which the scheduler obtains
+ * new trace processes
+ *
+ * Forking a trace directly from the scheduler forces the kernel to
+ * copy the page tables of the scheduler's entire address space, which
+ * grows with the state McMini accumulates during exploration (the
+ * transition and state stacks, the object store, etc.). A trace needs
+ * none of that state: it re-simulates the program from its start.
+ *
+ * The template is forked once, right after the scheduler has
+ * initialized itself and before exploration begins, so its address
+ * space stays as small as that of a freshly-loaded target. It waits
+ * on a socket for requests from the scheduler and forks a new trace
+ * for each of them.
+ *
+ * Traces are requested ahead of time: `SPARE_TRACE_PROCESSES` spare
+ * traces are kept parked just before the main routine of the target,
+ * and each spare handed out is replaced right away, so that the
+ * template forks the next trace while the scheduler explores with the
+ * current one.
+ *
+ * Each trace is re-parented to the scheduler (the scheduler is marked
+ * a child subreaper and the template forks each trace through a short-
+ * lived intermediate process), so that the scheduler can `waitpid()`
+ * on it and read its memory exactly as it would a trace it forked
+ * itself.
+ *
+ * The template is not used when the environment variable
+ * `MCMINI_NO_TRACE_TEMPLATE` is set (as McMini's GDB scripts do, since
+ * they expect each trace to be forked by the scheduler), in which case
+ * this function does nothing
+ */
+void mc_spawn_trace_template();
+
+/**
+ * @brief Hands out a spare trace process from the template as the new
+ * trace, asking the template for a replacement
+ *
+ * The new trace runs the same code a trace forked directly by the
+ * scheduler runs (see `mc_prepare_trace_process()`); in particular, it
+ * blocks until the scheduler allows it to enter the main routine of
+ * the target program. The scheduler must have re-initialized the given
+ * generation of `trace_sleep_list`, which the trace is to use,
+ * beforehand.
+ *
+ * @return the process id of the new trace, a child of the scheduler,
+ * or -1 if there is no template process to ask, in which case the
+ * scheduler must fork the trace itself
+ */
+pid_t mc_fork_trace_from_template(unsigned generation);
+
+#endif // INCLUDE_MCMINI_MC_TRACE_TEMPLATE_H
@@ -0,0 +1,57 @@
+#ifndef INCLUDE_MCMINI_MC_TRACE_WATCHDOG_H
+#define INCLUDE_MCMINI_MC_TRACE_WATCHDOG_H
+
+#include <sys/types.h>
+
+extern "C" {
+#include "mc_shared_sem.h"
+}
+
+/**
+ * @brief Reads the time budgets of traces from the environment
+ *
+ * A trace may be given a budget of wall-clock time and of CPU time
+ * (of all of its threads together), both per step (the execution of a
+ * thread from one visible operation to the next) and for the trace as
+ * a whole, in milliseconds:
+ *
+ *  - `MCMINI_STEP_TIMEOUT` (`--step-timeout`)
+ *  - `MCMINI_TRACE_TIMEOUT` (`--trace-timeout`)
+ *  - `MCMINI_STEP_CPU_LIMIT` (`--step-cpu-limit`)
+ *  - `MCMINI_TRACE_CPU_LIMIT` (`--trace-cpu-limit`)
+ *
+ * A thread that spins between visible operations (e.g. busy-waiting
+ * on a plain flag) never hands control back to the scheduler; without
+ * a budget, the scheduler waits for it forever. Without any budget
+ * set, the scheduler waits on traces exactly as it always has
+ */
+void mc_load_trace_budgets();
+
+/**
+ * @brief Whether any time budget is set for traces
+ */
+bool mc_has_trace_budgets();
+
+/**
+ * @brief Starts charging the time spent by the trace with the given
+ * process id, which becomes the current trace, against its budgets
+ */
+void mc_start_trace_budget(pid_t pid);
+
+/**
+ * @brief Waits for a thread of the current trace to reach its next
+ * visible operation, as `mc_shared_sem_wait_for_thread()` does, as long
+ * as the trace stays within its budgets
+ *
+ * @return whether the thread reached its next visible operation, or
+ * false if the trace ran out of a budget first, in which case
+ * `mc_exceeded_trace_budget()` tells which
+ */
+bool mc_wait_for_thread_within_budget(mc_shared_sem_ref sem);
+
+/**
+ * @brief A description of the budget the current trace last exceeded
+ */
+const char *mc_exceeded_trace_budget();
+
+#endif // INCLUDE_MCMINI_MC_TRACE_WATCHDOG_H
@@ -7,6 +7,8 @@
 #include "MCSharedTransition.h"
 #include "MCStack.h"
 #include "mcmini_wrappers.h"
+#include <string>
+#include <unordered_map>
 
 extern "C" {
 #include "MCCommon.h"
@@ -63,44 +65,110 @@ extern MC_THREAD_LOCAL tid_t tid_self;
  * unsafe and would need to be atomic
  */
 extern trid_t traceId;
+
+/**
+ * @brief The number of transitions McMini has run in the search so far
+ */
+extern trid_t transitionId;
+
 extern pid_t trace_pid;
 
 /**
- * @brief A fixed-size array assigning to each possible
- * thread of a McMini trace-process a location that at any given time
- * can receive notifications (and send notifications to) the
- * scheduler.
+ * @brief The process id of the scheduler
+ */
+extern pid_t scheduler_pid;
+
+/**
+ * @brief An array assigning to each thread of a McMini trace-process
+ * a location that at any given time can receive notifications (and
+ * send notifications to) the scheduler.
  *
  * When a thread in a trace process is created, it blocks on a
  * semaphore in shared memory uniquely pre-assigned to it contained
  * within this list. The thread ID assigned to it by McMini is treated
- * as an index into this list
- *
- * The list is of a fixed size to give the scheduler awareness of the
- * threads that it will have to deal with and, more importantly, so
- * that it can initialize the semaphores contained in the list to the
- * appropriate values
+ * as an index into this list (see `mc_trace_sleep_list_slot()`)
  *
- * FIXME: It *may* be possible to allow the list to have a variable
- * size. This would have to be communicated somehow back to the
- * scheduler, which would be complicated as the scheduler cannot know
- * a prior if new threads will be created. It's something to consider
- * in the future
+ * The list lives at the end of the shared memory region and grows a
+ * page at a time. Since a single transition creates at most one new
+ * thread, the scheduler keeps one slot more than the number of
+ * threads it knows about (see `mc_grow_trace_sleep_list()`) and
+ * initializes that slot itself before the trace can reach it. A
+ * trace process that creates a thread beyond the slots it has mapped
+ * only needs to map the slots the scheduler already added (see
+ * `mc_map_trace_sleep_list()`)
  *
  * FIXME: Shared memory management should occur within a dedicated
  * object perhaps that wraps the memory and makes sure it is cleaned
- * up when the object is destroyed. Furthermore, we should de-couple
- * indexing the list with the thread ID and instead think of the
- * thread ID as a key in a map
+ * up when the object is destroyed
  */
-extern mc_shared_sem (
-  *trace_sleep_list)[MAX_TOTAL_THREADS_IN_PROGRAM];
+extern mc_shared_sem *trace_sleep_list;
+
+/**
+ * @brief The number of slots of `trace_sleep_list` mapped into the
+ * address space of this process
+ */
+extern size_t trace_sleep_list_capacity;
+
+/**
+ * @brief The set of slots of `trace_sleep_list` used by the current
+ * trace
+ *
+ * Each thread has one slot in each of `TRACE_SLEEP_LIST_GENERATIONS`
+ * generations, and no two live traces use the same generation. A trace
+ * left to exit in the background (see `mc_terminate_trace()`) may
+ * still have threads waiting on its semaphores while the next trace
+ * runs, as may traces replaying a branch ahead of time (see
+ * `mc_start_trace_pipeline()`); a wake-up meant for one trace must not
+ * go to a thread of another.
+ *
+ * Each generation also has its own mailbox at the start of the shared
+ * memory region (see `mc_select_trace_mailbox()`)
+ */
+extern unsigned trace_sleep_list_generation;
+
+/**
+ * @brief The slot of `trace_sleep_list` of the thread with the given
+ * id in the given generation
+ */
+inline mc_shared_sem_ref
+mc_trace_sleep_list_slot_of_generation(tid_t tid, unsigned generation)
+{
+  return &trace_sleep_list[tid * TRACE_SLEEP_LIST_GENERATIONS + generation];
+}
+
+/**
+ * @brief The slot of `trace_sleep_list` of the thread with the given
+ * id in the current trace
+ */
+inline mc_shared_sem_ref
+mc_trace_sleep_list_slot(tid_t tid)
+{
+  return mc_trace_sleep_list_slot_of_generation(tid,
+                                                trace_sleep_list_generation);
+}
 
 /**
  * @brief Initializes the variables in the global `trace_sleep_list`
  */
 void mc_initialize_trace_sleep_list();
 
+/**
+ * @brief Ensures that `trace_sleep_list` has initialized slots for
+ * at least `count` threads, extending the shared memory region as
+ * needed
+ *
+ * Only the scheduler calls this function, and only while no thread
+ * of the trace process can touch the new slots
+ */
+void mc_grow_trace_sleep_list(size_t count);
+
+/**
+ * @brief Maps into a trace process the slots of `trace_sleep_list`
+ * the scheduler has added since the trace was forked, so that the
+ * slots of at least `count` threads are accessible
+ */
+void mc_map_trace_sleep_list(size_t count);
+
 /**
  * @brief Destorys and then re-initializes the elements of
  * `trace_sleep_list`
@@ -115,6 +183,36 @@ void mc_initialize_trace_sleep_list();
  */
 void mc_reset_trace_sleep_list();
 
+/**
+ * @brief Readies a generation of `trace_sleep_list` no live trace uses
+ * for a trace to be replayed ahead of time, leaving the generation of
+ * the current trace as it is
+ *
+ * The generation is held, and skipped when readying a generation for
+ * any other trace, until it is either adopted as that of the current
+ * trace (see `mc_adopt_trace()`) or released
+ */
+unsigned mc_claim_trace_sleep_list_generation();
+
+/**
+ * @brief Releases a generation claimed with
+ * `mc_claim_trace_sleep_list_generation()` whose trace was terminated
+ *
+ * @param lastUser a pidfd of the trace, left to exit in the
+ * background, or -1 if the trace has been reaped
+ */
+void mc_release_trace_sleep_list_generation(unsigned generation,
+                                            int lastUser);
+
+/**
+ * @brief Points `shmTransitionTypeInfo` and `shmTransitionData` at the
+ * mailbox of the given generation of `trace_sleep_list`
+ *
+ * A trace selects the mailbox of its generation as it starts; the
+ * scheduler, that of the current trace
+ */
+void mc_select_trace_mailbox(unsigned generation);
+
 /**
  * @brief A binary semaphore that is used to ensure that threads
  * created in trace processes have fully initialized before the
@@ -150,7 +248,11 @@ extern sem_t mc_pthread_create_binary_sem;
 extern void *shmStart;
 
 /**
- * @brief The size of the shared memory allocation in bytes
+ * @brief The size in bytes of the mailboxes at the start of the shared
+ * memory region, one for each generation of `trace_sleep_list` and each
+ * rounded up to a whole number of pages
+ *
+ * The `trace_sleep_list` begins immediately after the mailboxes
  */
 extern const size_t shmAllocationSize;
 
@@ -213,8 +315,9 @@ void mc_create_global_state_object();
 /**
  * @brief Return id for the operation type of objectID
  *
- * This counts how many objects, i,  of the same type
- * as objectId exist, for i < ojbectId.
+ * This is how many objects, i,  of the same type
+ * as objectId exist, for i <= objectId. The store records it
+ * when the object is registered, so this is a single lookup.
  */
 int countVisibleObjectsOfType(int objectId);
 
@@ -300,6 +403,67 @@ mc_search_dpor_branch_with_thread(const tid_t leadThread);
  */
 void mc_fork_new_trace();
 
+/**
+ * @brief Forks a new trace process which is to use the given
+ * generation of `trace_sleep_list`, readied beforehand, and returns its
+ * process id
+ *
+ * The trace is blocked before the main routine of the target until
+ * the scheduler wakes it, as with `mc_fork_new_trace()`, but it is not
+ * made the current trace
+ */
+pid_t mc_fork_trace_process(unsigned generation);
+
+/**
+ * @brief The objects the steps of a trace have reached so far (see
+ * `mc_shared_sem::reached_object`), numbered in the order they were
+ * first reached
+ *
+ * The target knows an object by its address, which changes from one
+ * trace to the next unless every trace is forked from the same image
+ * (e.g. with `MCMINI_NO_TRACE_TEMPLATE`, a lock allocated with malloc()
+ * or the argument of pthread_create()). A trace which goes the same way
+ * as another reaches its objects in the same order: the checksums of
+ * steps name objects by their number instead
+ */
+struct mc_reached_objects {
+  std::unordered_map<uint64_t, uint64_t> ordinals;
+
+  /* The number of the object, 0 standing for no object */
+  uint64_t ordinalOf(uint64_t object);
+};
+
+/**
+ * @brief Makes a trace forked with `mc_fork_trace_process()` and
+ * brought to the current state of the transition stack by other means
+ * than `mc_fork_next_trace_at_current_state()` the current trace
+ *
+ * @param objects the objects reached by the steps the trace was brought
+ * through, taken over as those of the current trace
+ */
+void mc_adopt_trace(pid_t pid, unsigned generation,
+                    mc_reached_objects &objects);
+
+/**
+ * @brief Readies the calling process, a newly-forked child of the
+ * scheduler, to act as a trace process
+ *
+ * The process discards the scheduler's model of the program and
+ * registers its main thread. It does not touch `trace_sleep_list`, so
+ * a process may be readied before the scheduler has re-initialized the
+ * list for the trace it will run (see `mc_spawn_trace_template()`)
+ */
+void mc_prepare_trace_process();
+
+/**
+ * @brief Blocks the main thread of a trace process readied with
+ * `mc_prepare_trace_process()` until the scheduler allows it to run
+ *
+ * The process then resumes inside `mcmini_main()` from where it returns
+ * to the target program. This function never returns to its caller
+ */
+void mc_start_trace_process();
+
 /**
  * @brief Forks a new trace process whose execution is blocked until
  * the scheduler wakes it
@@ -322,7 +486,29 @@ void mc_fork_new_trace_at_main();
  * scheduler at the particular point in the past (i.e. backtracking
  * point)
  */
-void mc_fork_next_trace_at_current_state();
+/**
+ * @brief Forks a new trace and replays the transitions of the
+ * transition stack in it
+ *
+ * The transitions are replayed one at a time, in the order of the
+ * stack. With the environment variable `MCMINI_CONCURRENT_REPLAY`
+ * (`--concurrent-replay`) set, a thread is instead let go as soon as
+ * the transitions its next one depends on (according to the clock
+ * vectors of the state stack) have been replayed, so that threads
+ * computing between independent visible operations do so in parallel,
+ * up to `MC_CONCURRENT_REPLAY_WINDOW` steps ahead of the earliest step
+ * not yet replayed. Creating a thread and ending the process are
+ * replayed on their own. A target whose threads share data outside of
+ * visible operations (or read the virtual clock, see `MCTimeWrappers.h`)
+ * may then be replayed differently from the original run, which is
+ * reported as a divergence (see `mc_report_replay_divergence()`)
+ *
+ * @return whether the replay completed, or false if the trace ran out
+ * of its time budget during the replay (see
+ * `mc_report_trace_over_budget()`) or diverged from the original run
+ * of the transitions (see `mc_report_replay_divergence()`)
+ */
+bool mc_fork_next_trace_at_current_state();
 
 /**
  * @brief Unblocks the thread corresponding to _tid_ in the current
@@ -330,16 +516,95 @@ void mc_fork_next_trace_at_current_state();
  *
  * The caller will block until the thread in the trace process
  *
- * FIXME: We currently do not properly handle the case where the trace
- * process dies unexpectedly. Instead of deadlocking in the scheduler,
- * a more graceful approach would be to detect this with e.g. the
- * result of waitpid() in a separate thread spawned by McMini that
- * simply acts as a "watchdog" for bad events such as these
+ * Should the trace process die in the meantime, the scheduler is
+ * woken up regardless (see `mc_notify_trace_stopped_early()`) and
+ * reports the failure; this function then does not return
  *
  * @param tid the ID of the thread to allow to execute in the trace
  * process
+ * @return whether the thread reached its next visible operation, or
+ * false if the trace exceeded one of its time budgets (see
+ * `mc_load_trace_budgets()`), in which case the trace has been
+ * reported and terminated
  */
-void mc_run_thread_to_next_visible_operation(tid_t tid);
+bool mc_run_thread_to_next_visible_operation(tid_t tid);
+
+/**
+ * @brief Unblocks the thread with the given id in the current trace, as
+ * `mc_run_thread_to_next_visible_operation()` does, without waiting for
+ * it
+ */
+void mc_wake_thread_for_next_visible_operation(tid_t tid);
+
+/**
+ * @brief Waits for a thread unblocked with
+ * `mc_wake_thread_for_next_visible_operation()` to reach its next
+ * visible operation, as `mc_run_thread_to_next_visible_operation()`
+ * does
+ */
+bool mc_await_thread_at_next_visible_operation(tid_t tid);
+
+/**
+ * @brief Reports that the current trace exceeded one of its time budgets
+ * while the thread with the given id was running and terminates it
+ *
+ * The trace is recorded as a livelock or timeout, and model checking
+ * goes on with the next branch
+ */
+void mc_report_trace_over_budget(tid_t tid);
+
+/**
+ * @brief Folds the step just run by the thread with the given id, as
+ * told by the visible operation the thread has reached (see
+ * `mc_shared_sem::reached_type`), into a rolling checksum of the steps
+ * of a trace
+ *
+ * @param slot the thread's slot of `trace_sleep_list` in the generation
+ * of its trace
+ * @param objects the objects reached by the steps of the trace before
+ * this one, in which the object the thread reached is numbered
+ */
+uint64_t mc_checksum_step(uint64_t checksum, tid_t tid,
+                          mc_shared_sem_ref slot,
+                          mc_reached_objects &objects);
+
+/**
+ * @brief The checksum recorded with `mc_record_step_checksum()` for
+ * the step of the transition stack at the given index
+ */
+uint64_t mc_step_checksum(int step);
+
+/**
+ * @brief Records the checksum of the steps of the transition stack up
+ * to the one at the given index, just run for the first time by the
+ * thread with the given id, for replays to be checked against
+ */
+void mc_record_step_checksum(int step, tid_t tid);
+
+/**
+ * @brief Reports that replaying the step at the given index in the
+ * current trace did not lead the thread with the given id to the same
+ * visible operation as when it was first run, and terminates the trace
+ *
+ * Rather than explore a branch that does not exist, model checking
+ * goes on with the next branch
+ */
+void mc_report_replay_divergence(int step, tid_t tid);
+
+/**
+ * @brief Tells the scheduler that the current trace has exited
+ * without being asked to, waking it if it waits on the trace
+ *
+ * This function is async-signal-safe and may be called from any thread
+ * of the scheduler
+ */
+void mc_notify_trace_stopped_early();
+
+/**
+ * @brief Reports that the current trace has exited without being asked
+ * to and stops model checking
+ */
+void mc_report_trace_stopped_early();
 
 /**
  * @brief Blocks execution of the calling thread until the current
@@ -348,7 +613,19 @@ void mc_run_thread_to_next_visible_operation(tid_t tid);
 void mc_wait_for_trace();
 
 /**
- * @brief Halts the current trace and waits for it to exit
+ * @brief Reports (in verbose mode) how the trace process with the given
+ * id exited
+ *
+ * @param status the status of the trace as returned by `waitpid()`
+ */
+void mc_report_trace_exit(trid_t id, int status);
+
+/**
+ * @brief Halts the current trace
+ *
+ * The trace is left to exit in the background if McMini's trace reaper
+ * is running (see `mc_start_trace_reaper()`); otherwise, the scheduler
+ * waits for it to exit
  */
 void mc_terminate_trace();
 
@@ -392,7 +669,9 @@ void mc_exit(int);
  * McMini will abort execution and exit with the provided exit code.
  * Any shared memory allocated for cross-process communication will be
  * deallocated. If a trace process exists at the time the method is
- * executed, the trace process will first be killed
+ * executed, the trace process will first be killed. The scheduler's
+ * signal handlers call this method, so it must remain
+ * async-signal-safe
  *
  * @param status the exit code passed to the exit(2) system call
  */
@@ -434,6 +713,12 @@ MCStackConfiguration get_config_for_execution_environment();
 /* Trace prints */
 void mc_exit_with_trace_if_necessary(trid_t);
 
+/**
+ * @brief What `MCTransition::print()` prints of the given transition,
+ * without the line break at its end
+ */
+std::string mc_describe_transition(const MCTransition &transition);
+
 /* Registering and accessing threads */
 tid_t mc_register_thread();
 tid_t mc_register_main_thread();
@@ -4,10 +4,12 @@
 #include "transitions/wrappers/MCBarrierWrappers.h"
 #include "transitions/wrappers/MCConditionVariableWrappers.h"
 #include "transitions/wrappers/MCGlobalVariableWrappers.h"
+#include "transitions/wrappers/MCInputWrappers.h"
 #include "transitions/wrappers/MCMutexTransitionWrappers.h"
 #include "transitions/wrappers/MCRWLockWrappers.h"
 #include "transitions/wrappers/MCRWWLockWrappers.h"
 #include "transitions/wrappers/MCSemaphoreTransitionWrappers.h"
 #include "transitions/wrappers/MCThreadTransitionWrappers.h"
+#include "transitions/wrappers/MCTimeWrappers.h"
 
 #endif // INCLUDE_MCMINI_MCMINIWRAPPERS_HPP
@@ -0,0 +1,87 @@
+#ifndef MC_MCCHUNKEDARRAY_HPP
+#define MC_MCCHUNKEDARRAY_HPP
+
+#include <memory>
+#include <stddef.h>
+#include <vector>
+
+/**
+ * @brief An indexable sequence of elements that grows in
+ * fixed-size chunks
+ *
+ * Unlike a `std::vector`, growing an `MCChunkedArray` never moves the
+ * elements it already holds: a new chunk is allocated and appended,
+ * and the existing chunks are left in place. References to elements
+ * thus remain valid for the lifetime of the array and growing costs
+ * only the allocation of the new chunk.
+ *
+ * Chunks are never released once allocated, so an array that is
+ * repeatedly grown to the same depth (as the transition and state
+ * stacks are with each new trace) allocates only once. Indexing costs
+ * a shift and a mask
+ *
+ * @tparam T the type of element stored in the array
+ * @tparam ChunkShift the base-2 logarithm of the number of elements
+ * in each chunk
+ */
+template<typename T, unsigned ChunkShift = 8>
+struct MCChunkedArray final {
+private:
+
+  static constexpr size_t chunkSize = size_t(1) << ChunkShift;
+  static constexpr size_t chunkMask = chunkSize - 1;
+
+  std::vector<std::unique_ptr<T[]>> chunks;
+
+public:
+
+  /**
+   * @brief The number of elements the array can hold without
+   * allocating another chunk
+   */
+  inline size_t
+  capacity() const
+  {
+    return this->chunks.size() << ChunkShift;
+  }
+
+  /**
+   * @brief Ensures that the array has storage for at least `count`
+   * elements, allocating (default-constructed) chunks as needed
+   */
+  inline void
+  reserve(size_t count)
+  {
+    while (this->capacity() < count)
+      this->chunks.emplace_back(new T[chunkSize]());
+  }
+
+  /**
+   * @brief Returns the element at the given index, first allocating
+   * storage for it if necessary
+   */
+  inline T &
+  at(size_t index)
+  {
+    this->reserve(index + 1);
+    return (*this)[index];
+  }
+
+  /**
+   * @brief Returns the element at the given index, which must be
+   * less than `capacity()`
+   */
+  inline T &
+  operator[](size_t index)
+  {
+    return this->chunks[index >> ChunkShift][index & chunkMask];
+  }
+
+  inline const T &
+  operator[](size_t index) const
+  {
+    return this->chunks[index >> ChunkShift][index & chunkMask];
+  }
+};
+
+#endif /* MC_MCCHUNKEDARRAY_HPP */
@@ -1,22 +1,38 @@
 #ifndef MC_MCTYPES_HPP
 #define MC_MCTYPES_HPP
-#include <typeinfo>
-#include <functional>
+#include <stdint.h>
 
-using TypeInfoRef = std::reference_wrapper<const std::type_info>;
-using MCType = const std::type_info&;
+/**
+ * @brief A dense integer identifying a kind of transition that
+ * McMini knows how to handle
+ *
+ * Transition type ids are handed out in order of registration with
+ * `MCStack::registerVisibleOperationType()` and double as indices
+ * into the table of shared memory handlers. Unlike the address of a
+ * `std::type_info`, the id is a plain value: it can be written into
+ * the shared memory mailbox and read back in any process (or any
+ * binary) that registered the same transitions in the same order
+ */
+typedef uint32_t MCTransitionTypeID;
+#define MC_TRANSITION_TYPE_INVALID (UINT32_MAX)
 
-struct TypeHasher {
-    std::size_t operator()(TypeInfoRef code) const
-    {
-        return code.get().hash_code();
-    }
+/**
+ * @brief Associates a transition subclass with the id it was
+ * assigned at registration time
+ *
+ * Wrapper functions use `MCTransitionType<T>::id` to announce the
+ * transition they are about to run. Reading the id is a single load
+ * of a static variable, so the trace process never has to search for
+ * the type it wants to post. Trace processes are forked from the
+ * scheduler after registration, so they see the same ids
+ */
+template<typename Transition>
+struct MCTransitionType {
+  static MCTransitionTypeID id;
 };
 
-struct TypesEqual {
-    bool operator()(TypeInfoRef lhs, TypeInfoRef rhs) const
-    {
-        return lhs.get() == rhs.get();
-    }
-};
-#endif /* MC_MCTYPES_HPP */
\ No newline at end of file
+template<typename Transition>
+MCTransitionTypeID MCTransitionType<Transition>::id =
+  MC_TRANSITION_TYPE_INVALID;
+
+#endif /* MC_MCTYPES_HPP */
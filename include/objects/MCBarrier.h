@@ -39,7 +39,9 @@ public:
   }
   inline MCBarrier(const MCBarrier &barrier)
     : MCVisibleObject(barrier.getObjectId()),
-      barrierShadow(barrier.barrierShadow)
+      threadsWaitingOnBarrierOdd(barrier.threadsWaitingOnBarrierOdd),
+      threadsWaitingOnBarrierEven(barrier.threadsWaitingOnBarrierEven),
+      isEven(barrier.isEven), barrierShadow(barrier.barrierShadow)
   {
   }
 
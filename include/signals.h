@@ -19,6 +19,18 @@ int install_sighandles_for_trace();
 void sigusr1_handler_trace(int sig);
 void sigusr2_handler_trace(int sig);
 
+/**
+ * @brief Registers signal handlers for the process from which traces
+ * are forked (see `mc_spawn_trace_template()`)
+ *
+ * The handlers of the scheduler are removed, and SIGINT is ignored
+ * so that ^C is handled by the scheduler alone
+ *
+ * @return 0 if all signal handlers were successfully installed;
+ * otherwise a nonzero value is returned
+ */
+int install_sighandles_for_trace_template();
+
 /**
  * @brief Registers signal handlers for the scheduler process
  *
@@ -26,6 +38,18 @@ void sigusr2_handler_trace(int sig);
  * otherwise a nonzero value is returned
  */
 int install_sighandles_for_scheduler();
+
+/**
+ * @brief Registers a SIGCHLD handler with the scheduler to detect the
+ * trace exiting early
+ *
+ * The handler is only needed when there is no trace reaper to watch
+ * the trace (see `mc_start_trace_reaper()`)
+ *
+ * @return 0 if the signal handler was successfully installed;
+ * otherwise a nonzero value is returned
+ */
+int install_sigchld_handler_for_scheduler();
 void sigint_handler_scheduler(int sig);
 void sigusr1_handler_scheduler(int sig);
 void sigchld_handler_scheduler(int sig, siginfo_t *, void *);
@@ -12,6 +12,7 @@
 #include "transitions/semaphore/MCSemaphoreDefs.h"
 #include "transitions/threads/MCThreadDefs.h"
 #include <pthread.h>
+#include <string.h>
 #include <typeinfo>
 
 extern "C" {
@@ -19,9 +20,12 @@ extern "C" {
 }
 
 /* Source program thread control */
+void thread_record_visible_operation(MCTransitionTypeID type,
+                                     const void *payload, size_t size);
+
 template<typename SharedMemoryData>
 void
-thread_post_visible_operation_hit(const std::type_info &type,
+thread_post_visible_operation_hit(MCTransitionTypeID type,
                                   SharedMemoryData *shmData)
 {
   auto newTypeInfo = MCSharedTransition(tid_self, type);
@@ -33,9 +37,11 @@ thread_post_visible_operation_hit(const std::type_info &type,
          sizeof(MCSharedTransition));
   memcpy((char *)shmTransitionData, (char *)newShmData,
          sizeof(SharedMemoryData));
+  thread_record_visible_operation(type, newShmData,
+                                  sizeof(SharedMemoryData));
 }
 
-void thread_post_visible_operation_hit(const std::type_info &type);
+void thread_post_visible_operation_hit(MCTransitionTypeID type);
 
 void thread_await_scheduler();
 void thread_await_scheduler_for_thread_start_transition();
@@ -0,0 +1,59 @@
+#ifndef MC_MCINPUTWRAPPERS_H
+#define MC_MCINPUTWRAPPERS_H
+
+#include "MCShared.h"
+#include <sys/types.h>
+
+/*
+ * Each branch McMini explores is reached by replaying, in a new trace,
+ * the transitions leading up to it, which relies on the target doing
+ * the same thing every time it is run along the same schedule. Calls
+ * that answer differently in each process (`rand()`, `random()`,
+ * `getrandom()` and `read()`s from `/dev/random` and `/dev/urandom`)
+ * would break that. Reads are told apart by the file descriptor alone,
+ * which is marked when `open()` or `openat()` is given either path
+ * (relative paths and descriptors past `MC_INPUT_TRACKED_FDS` are not
+ * marked) and unmarked when closed or replaced by `dup2()`/`dup3()`.
+ *
+ * Instead, the answers to such calls are kept in a log in memory shared
+ * by all traces: the n-th such call of a thread of a trace is given the
+ * answer recorded for the n-th such call of the same thread in an
+ * earlier trace, as long as that was the same call; otherwise, it is
+ * made for real and its answer recorded (over whatever the thread's log
+ * held from there on) for the traces to come. Calls of threads beyond the
+ * first `MC_INPUT_LOG_THREADS`, and calls once a thread's log is full,
+ * are made for real.
+ *
+ * `getpid()` is not replayed: each trace is given its own process id,
+ * which the target may well use to signal itself or to look itself up
+ * in /proc. Its calls still take up a place in the log, so a target
+ * branching on its process id may not replay the same way.
+ *
+ * Only the current trace of the scheduler records answers: a trace
+ * replaying a branch ahead of time (see `mc_start_trace_pipeline()`)
+ * makes any call it finds no answer for for real and leaves the log as
+ * it is (see `mc_set_input_log_writer()`).
+ *
+ * The scheduler, and traces when the environment variable
+ * `MCMINI_NO_INPUT_REPLAY` is set, make all calls for real.
+ */
+MC_EXTERN void mc_create_input_log();
+MC_EXTERN void mc_set_input_log_writer(unsigned generation);
+MC_EXTERN void mc_start_trace_input_log();
+
+MC_EXTERN pid_t mc_getpid();
+MC_EXTERN int mc_rand();
+MC_EXTERN long mc_random();
+MC_EXTERN ssize_t mc_getrandom(void *buf, size_t len, unsigned int flags);
+MC_EXTERN ssize_t mc_read(int fd, void *buf, size_t count);
+MC_EXTERN int mc_open(const char *path, int flags, mode_t mode);
+MC_EXTERN int mc_open64(const char *path, int flags, mode_t mode);
+MC_EXTERN int mc_openat(int dirfd, const char *path, int flags,
+                        mode_t mode);
+MC_EXTERN int mc_openat64(int dirfd, const char *path, int flags,
+                          mode_t mode);
+MC_EXTERN int mc_close(int fd);
+MC_EXTERN int mc_dup2(int oldfd, int newfd);
+MC_EXTERN int mc_dup3(int oldfd, int newfd, int flags);
+
+#endif // MC_MCINPUTWRAPPERS_H
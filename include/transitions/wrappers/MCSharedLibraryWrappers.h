@@ -2,9 +2,13 @@
 #define INCLUDE_MCMINI_TRANSITIONS_WRAPPERS_MCSHAREDLIBRARYWRAPPERS_HPP
 
 #include <dlfcn.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdlib.h>
+#include <sys/random.h>
+#include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
 extern typeof(&pthread_create) pthread_create_ptr;
@@ -29,6 +33,27 @@ extern typeof(&pthread_rwlock_rdlock) pthread_rwlock_rdlock_ptr;
 extern typeof(&pthread_rwlock_wrlock) pthread_rwlock_wrlock_ptr;
 extern typeof(&pthread_rwlock_unlock) pthread_rwlock_unlock_ptr;
 extern typeof(&sleep) sleep_ptr;
+extern typeof(&usleep) usleep_ptr;
+extern typeof(&nanosleep) nanosleep_ptr;
+extern typeof(&clock_nanosleep) clock_nanosleep_ptr;
+extern typeof(&clock_gettime) clock_gettime_ptr;
+extern typeof(&gettimeofday) gettimeofday_ptr;
+extern typeof(&time) time_ptr;
+extern typeof(&pthread_cond_timedwait) pthread_cond_timedwait_ptr;
+extern typeof(&sem_timedwait) sem_timedwait_ptr;
+extern typeof(&pthread_mutex_timedlock) pthread_mutex_timedlock_ptr;
+extern typeof(&getpid) getpid_ptr;
+extern typeof(&rand) rand_ptr;
+extern typeof(&random) random_ptr;
+extern typeof(&getrandom) getrandom_ptr;
+extern typeof(&read) read_ptr;
+extern typeof(&open) open_ptr;
+extern typeof(&open64) open64_ptr;
+extern typeof(&openat) openat_ptr;
+extern typeof(&openat64) openat64_ptr;
+extern typeof(&close) close_ptr;
+extern typeof(&dup2) dup2_ptr;
+extern typeof(&dup3) dup3_ptr;
 
 #define __real_pthread_create         (*pthread_create_ptr)
 #define __real_pthread_join           (*pthread_join_ptr)
@@ -52,6 +77,27 @@ extern typeof(&sleep) sleep_ptr;
 #define __real_pthread_rwlock_wrlock  (*pthread_rwlock_wrlock_ptr)
 #define __real_pthread_rwlock_unlock  (*pthread_rwlock_unlock_ptr)
 #define __real_sleep                  (*sleep_ptr)
+#define __real_usleep                 (*usleep_ptr)
+#define __real_nanosleep              (*nanosleep_ptr)
+#define __real_clock_nanosleep        (*clock_nanosleep_ptr)
+#define __real_clock_gettime          (*clock_gettime_ptr)
+#define __real_gettimeofday           (*gettimeofday_ptr)
+#define __real_time                   (*time_ptr)
+#define __real_pthread_cond_timedwait (*pthread_cond_timedwait_ptr)
+#define __real_sem_timedwait          (*sem_timedwait_ptr)
+#define __real_pthread_mutex_timedlock (*pthread_mutex_timedlock_ptr)
+#define __real_getpid                 (*getpid_ptr)
+#define __real_rand                   (*rand_ptr)
+#define __real_random                 (*random_ptr)
+#define __real_getrandom              (*getrandom_ptr)
+#define __real_read                   (*read_ptr)
+#define __real_open                   (*open_ptr)
+#define __real_open64                 (*open64_ptr)
+#define __real_openat                 (*openat_ptr)
+#define __real_openat64               (*openat64_ptr)
+#define __real_close                  (*close_ptr)
+#define __real_dup2                   (*dup2_ptr)
+#define __real_dup3                   (*dup3_ptr)
 
 /**
  * @brief Retrieves the addresses of the symbols exposed by the
@@ -0,0 +1,62 @@
+#ifndef MC_MCTIMEWRAPPERS_H
+#define MC_MCTIMEWRAPPERS_H
+
+#include "MCShared.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Traces run against a virtual clock instead of the real one.
+ *
+ * Targets commonly sleep (e.g. to back off before retrying), which in
+ * a trace only stretches the time taken to explore it: whatever the
+ * sleep was meant to wait for is decided by the scheduler anyway. In
+ * a trace, sleeping instead advances the trace's clock by the time
+ * slept and returns at once, and the clocks the target can read
+ * (`clock_gettime()`, `gettimeofday()` and `time()`) tell the time of
+ * that clock. Sleeps thus still appear to take as long as they should
+ * to a target measuring them.
+ *
+ * The virtual clock of each trace starts at the time at which the
+ * scheduler started, so that every trace sees the same times for the
+ * same schedule. Each reading of the clock advances it by
+ * `MC_VIRTUAL_CLOCK_TICK_NS` so that a target polling the time until
+ * some deadline passes still gets there.
+ *
+ * Deadlines the target computes from the virtual clock mean nothing to
+ * the real one: the trace's clock runs ahead of it by however long the
+ * trace has slept. Timed waits McMini does not model
+ * (`pthread_cond_timedwait()`, `sem_timedwait()` and
+ * `pthread_mutex_timedlock()`) wait for real, so their deadlines are
+ * moved back onto the real clock and the virtual clock is advanced by
+ * the time spent waiting. Other waits taking a deadline (e.g.
+ * `sem_clockwait()` and `pthread_cond_clockwait()`) are not
+ * intercepted and are handed the virtual deadline as is.
+ *
+ * The scheduler, and traces when the environment variable
+ * `MCMINI_NO_VIRTUAL_TIME` is set, use the real clocks.
+ */
+MC_EXTERN void mc_start_virtual_clock();
+MC_EXTERN void mc_virtualize_trace_time();
+
+MC_EXTERN unsigned int mc_sleep(unsigned int seconds);
+MC_EXTERN int mc_usleep(useconds_t usec);
+MC_EXTERN int mc_nanosleep(const struct timespec *req,
+                           struct timespec *rem);
+MC_EXTERN int mc_clock_nanosleep(clockid_t clock, int flags,
+                                 const struct timespec *req,
+                                 struct timespec *rem);
+MC_EXTERN int mc_clock_gettime(clockid_t clock, struct timespec *tp);
+MC_EXTERN int mc_gettimeofday(struct timeval *tv, void *tz);
+MC_EXTERN time_t mc_time(time_t *tloc);
+MC_EXTERN int mc_pthread_cond_timedwait(pthread_cond_t *cond,
+                                        pthread_mutex_t *mutex,
+                                        const struct timespec *abstime);
+MC_EXTERN int mc_sem_timedwait(sem_t *sem, const struct timespec *abstime);
+MC_EXTERN int mc_pthread_mutex_timedlock(pthread_mutex_t *mutex,
+                                         const struct timespec *abstime);
+
+#endif // MC_MCTIMEWRAPPERS_H
@@ -26,6 +26,21 @@ static void mcprintf_redirect()
 static void mcprintf_stop_redirect() { mcprintf_idx = NORMAL; }
 #pragma GCC diagnostic pop
 
+/* While set, mcprintf() writes into this buffer instead (see
+ * mcprintf_capture()) */
+static char *mcprintf_capture_output = NULL;
+static size_t mcprintf_capture_size = 0;
+static size_t mcprintf_capture_len = 0;
+
+void mcprintf_capture(char *buf, size_t size)
+{
+  mcprintf_capture_output = buf;
+  mcprintf_capture_size = size;
+  mcprintf_capture_len = 0;
+  buf[0] = '\0';
+}
+void mcprintf_stop_capture() { mcprintf_capture_output = NULL; }
+
 bool is_redirect_stdout(bool strip_newline) {
   if (mcprintf_idx != NORMAL && strip_newline) { mcprintf_idx--; }
   return mcprintf_idx != NORMAL;
@@ -37,7 +52,15 @@ mcprintf(const char *format, ...)
   va_list args;
   va_start(args, format);
   int ret = -1;
-  if (! is_redirect_stdout(false)) {
+  if (mcprintf_capture_output != NULL) {
+    ret = vsnprintf(mcprintf_capture_output + mcprintf_capture_len,
+                    mcprintf_capture_size - mcprintf_capture_len,
+                    format, args);
+    if (ret > 0) mcprintf_capture_len += ret;
+    if (mcprintf_capture_len >= mcprintf_capture_size) { // then truncate:
+      mcprintf_capture_len = mcprintf_capture_size - 1;
+    }
+  } else if (! is_redirect_stdout(false)) {
     ret = vprintf(format, args);
     mcflush();
   } else {
@@ -1,11 +1,38 @@
 #include "MCObjectStore.h"
 
+constexpr objid_t MCObjectStore::OBJID_EMPTY;
+
+void
+MCObjectStore::growSystemVisibleObjectMap()
+{
+  const size_t newSize = systemVisibleObjectMap.empty()
+                           ? 64
+                           : 2 * systemVisibleObjectMap.size();
+  std::vector<SystemIdentitySlot> oldMap(
+    newSize, SystemIdentitySlot{nullptr, OBJID_EMPTY});
+  oldMap.swap(this->systemVisibleObjectMap);
+
+  for (const SystemIdentitySlot &slot : oldMap) {
+    if (slot.shadowId == OBJID_EMPTY) continue;
+    systemVisibleObjectMap[findSlotForSystemIdentity(slot.systemId)] =
+      slot;
+  }
+}
+
+void
+MCObjectStore::clear()
+{
+  this->storage.clear();
+  this->typeCounts.clear();
+  for (SystemIdentitySlot &slot : this->systemVisibleObjectMap)
+    slot.shadowId = OBJID_EMPTY;
+  this->systemVisibleObjectCount = 0;
+}
+
 void
 MCObjectStore::resetObjectsToInitialStateInStore()
 {
-  for (objid_t objid = static_cast<objid_t>(0);
-       objid <= this->storageTop; objid++) {
-    this->storage[objid]->current =
-      this->storage[objid]->initialState->copy();
+  for (StorageObject &object : this->storage) {
+    object.current = object.initialState->copy();
   }
 }
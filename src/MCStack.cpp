@@ -161,12 +161,13 @@ void MCStack::setNextTransitionForThread(tid_t tid,
                                          MCSharedTransition *shmTypeInfo,
                                          void *shmData) {
   // TODO: Assert when the type doesn't exist
-  auto maybeHandler = this->sharedMemoryHandlerTypeMap.find(shmTypeInfo->type);
-  if (maybeHandler == this->sharedMemoryHandlerTypeMap.end()) {
-    return;
-  }
+  const MCTransitionTypeID typeId = shmTypeInfo->type;
+  if (typeId >= this->sharedMemoryHandlers.size()) { return; }
+
+  MCSharedMemoryHandler handlerForType =
+    this->sharedMemoryHandlers[typeId];
+  if (handlerForType == nullptr) { return; }
 
-  MCSharedMemoryHandler handlerForType = maybeHandler->second;
   MCTransition *newTransitionForThread =
       handlerForType(shmTypeInfo, shmData, this);
   MC_FATAL_ON_FAIL(newTransitionForThread != nullptr);
@@ -177,6 +178,8 @@ void MCStack::setNextTransitionForThread(tid_t tid,
 
 tid_t MCStack::createNewThread(MCThreadShadow &shadow) {
   tid_t newTid = this->nextThreadId++;
+  this->nextTransitions.reserve(newTid + 1);
+  this->threadData.reserve(newTid + 1);
   auto rawThread = new MCThread(newTid, shadow);
   auto thread = std::shared_ptr<MCThread>(rawThread);
   objid_t newObjId = this->registerNewObject(thread);
@@ -203,12 +206,12 @@ tid_t MCStack::createMainThread() {
 void MCStack::restoreInitialTrace() {
   // Reset the modeled state of all objects
   this->nextThreadId = 0;
-  this->objectStorage = MCObjectStore();
+  this->objectStorage.clear();
 
   // Reset what we believe to be the next steps for each thread. In this
   // case we're starting from the beginning so `thread 0` is executing
   // the start transition
-  for (unsigned int i = 0; i < MAX_TOTAL_THREADS_IN_PROGRAM; i++) {
+  for (size_t i = 0; i < this->threadData.capacity(); i++) {
     this->nextTransitions[i] = nullptr;
     this->threadData[i] = MCThreadData();
   }
@@ -265,10 +268,14 @@ MCStack::getNumProgramThreads() const
 }
 
 void
-MCStack::registerVisibleOperationType(MCType type,
+MCStack::registerVisibleOperationType(MCTransitionTypeID &typeId,
                                       MCSharedMemoryHandler handler)
 {
-  this->sharedMemoryHandlerTypeMap.insert({type, handler});
+  if (typeId == MC_TRANSITION_TYPE_INVALID)
+    typeId = this->sharedMemoryHandlers.size();
+  if (typeId >= this->sharedMemoryHandlers.size())
+    this->sharedMemoryHandlers.resize(typeId + 1, nullptr);
+  this->sharedMemoryHandlers[typeId] = handler;
 }
 
 MCStackItem &
@@ -327,6 +334,18 @@ MCStack::getDeepestDPORBranchPoint()
 const MCTransition *MCStack::getFirstEnabledTransition() {
   int nextTraceEntry = getNextTraceSeqEntry(traceSeqIdx++);
   if (nextTraceEntry >= 0) {
+    // A traceSeq may name a thread which cannot run at this point (e.g.
+    // one of the schedules mcmini-minimize tries).  Running it anyway
+    // would leave the model out of step with the trace.  In a deadlock,
+    // mc_search_dpor_branch_with_thread() truncates the traceSeq.
+    if (static_cast<uint64_t>(nextTraceEntry) >= this->getNumProgramThreads() ||
+        (!MCTransition::transitionEnabledInState(
+           this, this->getNextTransitionForThread(nextTraceEntry)) &&
+         !this->isInDeadlock())) {
+      mcprintf("\n*** Thread %d of traceSeq cannot run at transition %d\n\n",
+               nextTraceEntry, traceSeqIdx);
+      mc_stop_model_checking(EXIT_FAILURE);
+    }
     // FIXME: This is more C++ obfuscation.
     //   We use '&' to convert from 'reference variable' to 'ptr'.
     // This happens because we're using 'reference variables' instead of ptrs.
@@ -468,16 +487,16 @@ bool
 MCStack::happensBefore(int i, int j) const
 {
   MC_ASSERT(i >= 0 && j >= 0);
-  const tid_t tid        = getThreadRunningTransitionAtIndex(i);
-  const MCClockVector cv = clockVectorForTransitionAtIndex(j);
+  const tid_t tid         = getThreadRunningTransitionAtIndex(i);
+  const MCClockVector &cv = clockVectorForTransitionAtIndex(j);
   return i <= (int)cv.valueForThread(tid).value_or(0);
 }
 
 bool
 MCStack::happensBeforeThread(int i, tid_t p) const
 {
-  const tid_t tid        = getThreadRunningTransitionAtIndex(i);
-  const MCClockVector cv = getThreadDataForThread(p).getClockVector();
+  const tid_t tid         = getThreadRunningTransitionAtIndex(i);
+  const MCClockVector &cv = getThreadDataForThread(p).getClockVector();
   return i <= (int)cv.valueForThread(tid).value_or(0);
 }
 
@@ -544,25 +563,20 @@ MCStack::dynamicallyUpdateBacktrackSets()
    */
   const uint64_t num_threads = this->getNumProgramThreads();
 
-  std::unordered_set<tid_t> thread_ids;
-  for (tid_t i = 0; i < num_threads; i++) thread_ids.insert(i);
-
   // 3. Determine the i
   const MCTransition &tStackTop  = this->getTransitionStackTop();
   const tid_t mostRecentThreadId = tStackTop.getThreadId();
   const MCTransition &nextTransitionForMostRecentThread =
     this->getNextTransitionForThread(mostRecentThreadId);
-  thread_ids.erase(mostRecentThreadId);
 
   // O(# threads)
   {
     const MCTransition &S_n = this->getTransitionStackTop();
     MCStackItem &s_n =
       this->getStateItemAtIndex(this->transitionStackTop);
-    const std::unordered_set<tid_t> enabledThreadsAt_s_n =
-      s_n.getEnabledThreadsInState();
 
-    for (tid_t tid : thread_ids) {
+    for (tid_t tid = 0; tid < num_threads; tid++) {
+      if (tid == mostRecentThreadId) continue;
       const MCTransition &nextSP =
         this->getNextTransitionForThread(tid);
       this->dynamicallyUpdateBacktrackSetsHelper(
@@ -596,8 +610,6 @@ MCStack::dynamicallyUpdateBacktrackSetsHelper(
   const MCTransition &S_i, MCStackItem &preSi,
   const MCTransition &nextSP, int i, tid_t p)
 {
-  const unordered_set<tid_t> enabledThreadsAtPreSi =
-    preSi.getEnabledThreadsInState();
   const bool shouldProcess =
     MCTransition::dependentTransitions(S_i, nextSP) &&
     MCTransition::coenabledTransitions(S_i, nextSP) &&
@@ -605,6 +617,8 @@ MCStack::dynamicallyUpdateBacktrackSetsHelper(
 
   // if there exists i such that ...
   if (shouldProcess) {
+    const unordered_set<tid_t> &enabledThreadsAtPreSi =
+      preSi.getEnabledThreadsInState();
     std::unordered_set<tid_t> E;
 
     for (tid_t q : enabledThreadsAtPreSi) {
@@ -717,6 +731,20 @@ MCStack::simulateRunningTransition(
                                    shmTransitionData);
 }
 
+void
+MCStack::replayRunningTransition(
+  const MCTransition &transition,
+  MCSharedTransition *shmTransitionTypeInfo, void *shmTransitionData)
+{
+  this->growTransitionStackRunning(transition);
+  this->growStateStack();
+  this->virtuallyRunTransition(transition);
+
+  tid_t tid = transition.getThreadId();
+  this->setNextTransitionForThread(tid, shmTransitionTypeInfo,
+                                   shmTransitionData);
+}
+
 void
 MCStack::incrementThreadDepthIfNecessary(
   const MCTransition &transition)
@@ -774,7 +802,7 @@ MCStack::growTransitionStackRunning(const MCTransition &transition)
 {
   auto transitionCopy = transition.staticCopy();
   this->transitionStackTop++;
-  this->transitionStack[this->transitionStackTop] = transitionCopy;
+  this->transitionStack.at(this->transitionStackTop) = transitionCopy;
 }
 
 void
@@ -789,7 +817,7 @@ MCStack::growStateStackWith(const MCClockVector &cv, bool revertible)
 {
   auto newState = std::make_shared<MCStackItem>(cv, revertible);
   this->stateStackTop++;
-  this->stateStack[this->stateStackTop] = newState;
+  this->stateStack.at(this->stateStackTop) = newState;
 }
 
 void
@@ -859,15 +887,15 @@ MCStack::transitionStackMaxClockVector(const MCTransition &transition)
     const MCTransition &t = getTransitionAtIndex(tStackIndex);
 
     if (MCTransition::dependentTransitions(t, transition)) {
-      const MCStackItem &s   = getStateItemAtIndex(i);
-      const MCClockVector clock_i = s.getClockVector();
-      cv                          = MCClockVector::max(clock_i, cv);
+      const MCStackItem &s         = getStateItemAtIndex(i);
+      const MCClockVector &clock_i = s.getClockVector();
+      cv                           = MCClockVector::max(clock_i, cv);
     }
   }
   return cv;
 }
 
-MCClockVector
+const MCClockVector &
 MCStack::clockVectorForTransitionAtIndex(int i) const
 {
   // The clock vector for transition `i` resides in
@@ -1098,6 +1126,22 @@ std::vector<tid_t> MCStack::getThreadIdBacktrace() const {
   return trace;
 }
 
+std::vector<int>
+MCStack::getCausalPredecessorsOfTransitionAtIndex(int i) const
+{
+  const tid_t tid         = this->getThreadRunningTransitionAtIndex(i);
+  const MCClockVector &cv = this->clockVectorForTransitionAtIndex(i);
+  const uint64_t nThreads = this->getNumProgramThreads();
+
+  auto predecessors = std::vector<int>();
+  for (tid_t other = 0; other < nThreads; other++) {
+    if (other == tid) continue;
+    const MCOptional<uint32_t> last = cv.valueForThread(other);
+    if (last.hasValue()) predecessors.push_back((int)last.value_or(0));
+  }
+  return predecessors;
+}
+
 MCStackConfiguration MCStack::getConfiguration() const {
   return this->configuration;
 }
@@ -22,6 +22,12 @@ MCStackItem::hasThreadsToBacktrackOn() const
   return !backtrackSet.empty();
 }
 
+size_t
+MCStackItem::getBacktrackSetSize() const
+{
+  return backtrackSet.size();
+}
+
 bool
 MCStackItem::isBacktrackingOnThread(tid_t tid) const
 {
@@ -64,19 +70,19 @@ MCStackItem::markThreadsEnabledInState(
     this->enabledThreads.insert(tid);
 }
 
-unordered_set<tid_t>
+const unordered_set<tid_t> &
 MCStackItem::getEnabledThreadsInState() const
 {
   return this->enabledThreads;
 }
 
-unordered_set<tid_t>
+const unordered_set<tid_t> &
 MCStackItem::getSleepSet() const
 {
   return this->sleepSet;
 }
 
-MCClockVector
+const MCClockVector &
 MCStackItem::getClockVector() const
 {
   return this->clockVector;
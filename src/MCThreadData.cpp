@@ -25,7 +25,7 @@ MCThreadData::resetExecutionData()
   this->executionPoints = MCSortedStack();
 }
 
-MCClockVector
+const MCClockVector &
 MCThreadData::getClockVector() const
 {
   return this->clockVector;
@@ -15,6 +15,20 @@
 #include <unistd.h>
 #include "config.h"
 
+// Sets the environment variable `env` to the time budget (in ms) given
+// as `value` to the option `option`
+static void
+set_time_budget(const char *option, const char *env, const char *value)
+{
+  char *endptr = NULL;
+  if (value != NULL) strtol(value, &endptr, 10);
+  if (value == NULL || endptr == value || endptr[0] != '\0') {
+    fprintf(stderr, "%s: illegal value\n", option);
+    exit(1);
+  }
+  setenv(env, value, 1);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -50,6 +64,20 @@ main(int argc, char *argv[])
       setenv(ENV_MAX_DEPTH_PER_THREAD, cur_arg[0] + 2, 1);
       cur_arg++;
     }
+    else if (strcmp(cur_arg[0], "--max-transitions") == 0 ||
+             strcmp(cur_arg[0], "-M") == 0) {
+      setenv(ENV_MAX_TRANSITIONS, cur_arg[1], 1);
+      char *endptr;
+      if (strtol(cur_arg[1], &endptr, 10) == 0 && endptr[0] != '\0') {
+        fprintf(stderr, "%s: illegal value\n", "--max-transitions");
+        exit(1);
+      }
+      cur_arg += 2;
+    }
+    else if (cur_arg[0][1] == 'M' && isdigit(cur_arg[0][2])) {
+      setenv(ENV_MAX_TRANSITIONS, cur_arg[0] + 2, 1);
+      cur_arg++;
+    }
     else if (cur_arg[0][1] == 'd' && isdigit(cur_arg[0][2])) {
       setenv(ENV_DEBUG_AT_TRACE_ID, cur_arg[0] + 2, 1);
       cur_arg++;
@@ -78,6 +106,91 @@ main(int argc, char *argv[])
       setenv(ENV_LONG_TEST, "1", 1);
       cur_arg++;
     }
+    else if (strcmp(cur_arg[0], "--no-virtual-time") == 0) {
+      setenv(ENV_NO_VIRTUAL_TIME, "1", 1);
+      cur_arg++;
+    }
+    else if (strcmp(cur_arg[0], "--no-input-replay") == 0) {
+      setenv(ENV_NO_INPUT_REPLAY, "1", 1);
+      cur_arg++;
+    }
+    else if (strcmp(cur_arg[0], "--no-output-capture") == 0) {
+      setenv(ENV_NO_OUTPUT_CAPTURE, "1", 1);
+      cur_arg++;
+    }
+    else if (strcmp(cur_arg[0], "--concurrent-replay") == 0) {
+      setenv(ENV_CONCURRENT_REPLAY, "1", 1);
+      cur_arg++;
+    }
+    else if (strcmp(cur_arg[0], "--results-fd") == 0) {
+      char *endptr = NULL;
+      if (cur_arg[1] != NULL) strtol(cur_arg[1], &endptr, 10);
+      if (cur_arg[1] == NULL || endptr == cur_arg[1] || endptr[0] != '\0') {
+        fprintf(stderr, "%s: illegal value\n", "--results-fd");
+        exit(1);
+      }
+      setenv(ENV_RESULTS_FD, cur_arg[1], 1);
+      cur_arg += 2;
+    }
+    else if (strcmp(cur_arg[0], "--exploration-tree") == 0) {
+      if (cur_arg[1] == NULL) {
+        fprintf(stderr, "%s: missing value\n", cur_arg[0]);
+        exit(1);
+      }
+      setenv(ENV_EXPLORATION_TREE, cur_arg[1], 1);
+      cur_arg += 2;
+    }
+    else if (strcmp(cur_arg[0], "--replay") == 0 ||
+             strcmp(cur_arg[0], "--replay-file") == 0) {
+      if (cur_arg[1] == NULL) {
+        fprintf(stderr, "%s: missing value\n", cur_arg[0]);
+        exit(1);
+      }
+      setenv(strcmp(cur_arg[0], "--replay") == 0 ? ENV_REPLAY
+                                                 : ENV_REPLAY_FILE,
+             cur_arg[1], 1);
+      cur_arg += 2;
+    }
+    else if (strcmp(cur_arg[0], "--profile") == 0) {
+      setenv(ENV_PROFILE, "0", 1);
+      cur_arg++;
+    }
+    else if (strcmp(cur_arg[0], "--profile-interval") == 0) {
+      char *endptr = NULL;
+      if (cur_arg[1] != NULL) strtol(cur_arg[1], &endptr, 10);
+      if (cur_arg[1] == NULL || endptr == cur_arg[1] || endptr[0] != '\0') {
+        fprintf(stderr, "%s: illegal value\n", "--profile-interval");
+        exit(1);
+      }
+      setenv(ENV_PROFILE, cur_arg[1], 1);
+      cur_arg += 2;
+    }
+    else if (strcmp(cur_arg[0], "--step-timeout") == 0) {
+      set_time_budget(cur_arg[0], ENV_STEP_TIMEOUT, cur_arg[1]);
+      cur_arg += 2;
+    }
+    else if (strcmp(cur_arg[0], "--trace-timeout") == 0) {
+      set_time_budget(cur_arg[0], ENV_TRACE_TIMEOUT, cur_arg[1]);
+      cur_arg += 2;
+    }
+    else if (strcmp(cur_arg[0], "--step-cpu-limit") == 0) {
+      set_time_budget(cur_arg[0], ENV_STEP_CPU_LIMIT, cur_arg[1]);
+      cur_arg += 2;
+    }
+    else if (strcmp(cur_arg[0], "--trace-cpu-limit") == 0) {
+      set_time_budget(cur_arg[0], ENV_TRACE_CPU_LIMIT, cur_arg[1]);
+      cur_arg += 2;
+    }
+    else if (strcmp(cur_arg[0], "--live-traces") == 0) {
+      char *endptr = NULL;
+      if (cur_arg[1] != NULL) strtol(cur_arg[1], &endptr, 10);
+      if (cur_arg[1] == NULL || endptr == cur_arg[1] || endptr[0] != '\0') {
+        fprintf(stderr, "%s: illegal value\n", "--live-traces");
+        exit(1);
+      }
+      setenv(ENV_LIVE_TRACES, cur_arg[1], 1);
+      cur_arg += 2;
+    }
     else if (strncmp(cur_arg[0], "--trace", strlen("--trace")) == 0 ||
              strncmp(cur_arg[0], "-t", strlen("-t")) == 0) {
       char *value;
@@ -111,8 +224,17 @@ main(int argc, char *argv[])
     else if (strcmp(cur_arg[0], "--help") == 0 ||
              strcmp(cur_arg[0], "-h") == 0) {
       fprintf(stderr, "Usage: mcmini [--max-depth-per-thread|-m <num>]\n"
+                      "              [--max-transitions|-M <num>]\n"
                       "              [--first-deadlock|--first|-f]\n"
-                      "              [--quiet|-q]\n"
+                      "              [--quiet|-q] [--no-output-capture]\n"
+                      "              [--no-virtual-time] [--no-input-replay]\n"
+                      "              [--step-timeout <ms>] [--trace-timeout <ms>]\n"
+                      "              [--step-cpu-limit <ms>] [--trace-cpu-limit <ms>]\n"
+                      "              [--live-traces <num>] [--concurrent-replay]\n"
+                      "              [--profile] [--profile-interval <seconds>]\n"
+                      "              [--results-fd <fd>]\n"
+                      "              [--exploration-tree <file>]\n"
+                      "              [--replay <traceSeq>|--replay-file <file>]\n"
                       "              [--trace|-t <num>|<traceSeq>]\n"
                       "              [--verbose|-v] [-v -v]\n"
                       "              [--help|-h]\n"
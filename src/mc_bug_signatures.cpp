@@ -0,0 +1,162 @@
+#include "mc_bug_signatures.h"
+#include "mcmini_private.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <ctype.h>
+#include <string.h>
+}
+
+struct mc_bug {
+  std::string kind;
+  uint64_t signatureHash;
+  trid_t firstTrace;
+  uint64_t traces;
+};
+
+/*
+ * NOTE: Allocated with the first bug: `mcmini_main()` is itself a
+ * constructor and may run before the constructors of this file
+ */
+static std::unordered_map<std::string, unsigned> *bugIds = nullptr;
+static std::vector<mc_bug> *bugs                         = nullptr;
+
+/*
+ * The ordinal of each address a signature has named, in the order they
+ * were first named (see `mc_describe_operation()`)
+ */
+static std::unordered_map<std::string, unsigned> *addressIds = nullptr;
+
+/*
+ * What `mc_describe_transition()` tells of a transition, less the
+ * thread running it. The addresses it gives (e.g. of the variables of
+ * READ and WRITE) change from one run of the target to the next: each
+ * is replaced by its ordinal instead ("addr:1"), which is the same from
+ * one run to the next since bugs are found in the same order
+ */
+static std::string
+mc_describe_operation(const MCTransition &transition)
+{
+  std::string operation = mc_describe_transition(transition);
+  if (operation.compare(0, 7, "thread ") == 0) {
+    const size_t colon = operation.find(": ");
+    if (colon != std::string::npos) operation.erase(0, colon + 2);
+  }
+
+  size_t start = 0;
+  while ((start = operation.find("0x", start)) != std::string::npos) {
+    size_t end = start + 2;
+    while (end < operation.size() && isxdigit((unsigned char)operation[end]))
+      end++;
+    const std::string address = operation.substr(start, end - start);
+    auto found = addressIds->find(address);
+    if (found == addressIds->end())
+      found = addressIds->emplace(address, addressIds->size() + 1).first;
+    const std::string ordinal = "addr:" + std::to_string(found->second);
+    operation.replace(start, end - start, ordinal);
+    start += ordinal.size();
+  }
+  return operation;
+}
+
+/*
+ * The part of a signature for one thread: the operation it is at and
+ * the last operation it ran
+ */
+static std::string
+mc_thread_signature(tid_t tid)
+{
+  std::string signature =
+    mc_describe_operation(programState->getNextTransitionForThread(tid));
+  signature += " after ";
+  for (int i = (int)programState->getTransitionStackSize() - 1; i >= 0; i--) {
+    if (programState->getThreadRunningTransitionAtIndex(i) == tid) {
+      signature +=
+        mc_describe_operation(programState->getTransitionAtIndex(i));
+      return signature;
+    }
+  }
+  signature += "nothing";
+  return signature;
+}
+
+unsigned
+mc_classify_bug(const char *kind, tid_t tid, bool *isNew)
+{
+  if (bugIds == nullptr) {
+    bugIds     = new std::unordered_map<std::string, unsigned>();
+    bugs       = new std::vector<mc_bug>();
+    addressIds = new std::unordered_map<std::string, unsigned>();
+  }
+
+  const uint64_t numThreads = programState->getNumProgramThreads();
+  std::vector<std::string> threads;
+  if (tid == TID_INVALID) {
+    for (tid_t i = 0; i < numThreads; i++) {
+      if (programState->getNextTransitionForThread(i).threadIsEnabled())
+        threads.push_back(mc_thread_signature(i));
+    }
+  } else {
+    threads.push_back(mc_thread_signature(tid));
+    if (strcmp(kind, "data_race") == 0) {
+      const MCTransition &racing =
+        programState->getNextTransitionForThread(tid);
+      for (tid_t i = 0; i < numThreads; i++) {
+        if (i != tid && MCTransition::transitionsInDataRace(
+                          programState->getNextTransitionForThread(i),
+                          racing))
+          threads.push_back(mc_thread_signature(i));
+      }
+    }
+  }
+  // Which thread is which does not matter
+  std::sort(threads.begin() + (tid == TID_INVALID ? 0 : 1), threads.end());
+
+  std::string signature = kind;
+  for (const std::string &thread : threads) {
+    signature += '\n';
+    signature += thread;
+  }
+
+  auto found = bugIds->find(signature);
+  *isNew     = found == bugIds->end();
+  if (*isNew) {
+    // FNV-1a, which unlike `std::hash` is the same from one build of
+    // McMini to the next
+    uint64_t hash = 0xcbf29ce484222325ul;
+    for (char c : signature) hash = (hash ^ (unsigned char)c) * 0x100000001b3ul;
+    bugs->push_back(mc_bug{kind, hash, traceId, 0});
+    found = bugIds->emplace(signature, (unsigned)bugs->size()).first;
+  }
+  (*bugs)[found->second - 1].traces++;
+  return found->second;
+}
+
+uint64_t
+mc_bug_signature_hash(unsigned bugId)
+{
+  return (*bugs)[bugId - 1].signatureHash;
+}
+
+unsigned
+mc_distinct_bug_count()
+{
+  return bugs == nullptr ? 0 : (unsigned)bugs->size();
+}
+
+void
+mc_print_distinct_bugs()
+{
+  if (mc_distinct_bug_count() == 0) return;
+  mcprintf("Number of distinct bugs: %u\n", mc_distinct_bug_count());
+  for (size_t i = 0; i < bugs->size(); i++) {
+    const mc_bug &bug = (*bugs)[i];
+    mcprintf("  Bug %lu (%s): first in traceId %lu, found in %lu trace%s\n",
+             (unsigned long)i + 1, bug.kind.c_str(),
+             (unsigned long)bug.firstTrace, (unsigned long)bug.traces,
+             bug.traces == 1 ? "" : "s");
+  }
+}
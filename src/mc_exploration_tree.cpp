@@ -0,0 +1,271 @@
+#include "mc_exploration_tree.h"
+#include "MCEnv.h"
+#include "mcmini_private.h"
+#include <vector>
+
+extern "C" {
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+}
+
+/*
+ * A way out of a state: the thread run from it, and what lies beneath
+ */
+struct mc_tree_branch {
+  tid_t thread;
+  long node = -1; // The next branch point down the branch, once written
+  uint64_t traces      = 0;
+  uint64_t transitions = 0;
+  uint64_t ns[MC_PHASE_COUNT] = {};
+
+  explicit mc_tree_branch(tid_t thread) : thread(thread) {}
+};
+
+/*
+ * A state of the current trace, with the branches out of it explored so
+ * far (the last one being that of the current trace)
+ */
+struct mc_tree_state {
+  std::vector<mc_tree_branch> branches;
+  bool reached      = false; // Whether the counts below are known
+  uint64_t enabled  = 0;
+  uint64_t asleep   = 0;
+  uint64_t backtrack = 0;
+  uint64_t replayNs = 0; // Forking and replaying traces branching off here
+};
+
+static FILE *treeFile = nullptr;
+static bool treeIsDot = false;
+static long nextNode  = 0;
+
+/* The states of the current trace, by depth, up to the last one a
+ * transition was run from */
+static std::vector<mc_tree_state> treePath;
+
+static bool traceOpen            = false;
+static bool traceEnded           = false;
+static int traceBranchPoint      = 0;
+static size_t traceLeaf          = 0;
+static uint64_t traceTransitions = 0;
+static uint64_t traceNs[MC_PHASE_COUNT];
+
+static uint64_t
+mc_total_ns(const uint64_t ns[MC_PHASE_COUNT])
+{
+  uint64_t total = 0;
+  for (int i = 0; i < MC_PHASE_COUNT; i++) total += ns[i];
+  return total;
+}
+
+void
+mc_open_exploration_tree()
+{
+  const char *path = getenv(ENV_EXPLORATION_TREE);
+  if (path == NULL) return;
+
+  treeFile = fopen(path, "w");
+  if (treeFile == NULL) {
+    fprintf(stderr, "McMini: %s: %s\n", path, strerror(errno));
+    mc_exit(EXIT_FAILURE);
+  }
+  const size_t length = strlen(path);
+  treeIsDot = length >= 4 && strcmp(path + length - 4, ".dot") == 0;
+  if (treeIsDot) {
+    fprintf(treeFile, "digraph exploration {\n"
+                      "  node [shape=box, fontsize=10];\n"
+                      "  edge [fontsize=9];\n");
+  }
+}
+
+static void
+mc_write_tree_node_json(long id, size_t depth, const mc_tree_state &state,
+                        const mc_tree_branch &total)
+{
+  fprintf(treeFile,
+          "{\"node\":%ld,\"depth\":%zu,\"enabled\":%lu,\"asleep\":%lu,"
+          "\"backtrack\":%lu,\"traces\":%lu,\"transitions\":%lu,"
+          "\"time_us\":{",
+          id, depth, (unsigned long)state.enabled,
+          (unsigned long)state.asleep, (unsigned long)state.backtrack,
+          (unsigned long)total.traces, (unsigned long)total.transitions);
+  for (int i = 0; i < MC_PHASE_COUNT; i++) {
+    fprintf(treeFile, "%s\"%s\":%lu", i > 0 ? "," : "",
+            mc_scheduler_phase_name((mc_scheduler_phase)i),
+            (unsigned long)(total.ns[i] / 1000));
+  }
+  fprintf(treeFile, "},\"replay_us\":%lu,\"branches\":[",
+          (unsigned long)(state.replayNs / 1000));
+  for (size_t i = 0; i < state.branches.size(); i++) {
+    const mc_tree_branch &branch = state.branches[i];
+    fprintf(treeFile, "%s{\"thread\":%lu,\"node\":", i > 0 ? "," : "",
+            (unsigned long)branch.thread);
+    if (branch.node >= 0) {
+      fprintf(treeFile, "%ld", branch.node);
+    } else {
+      fprintf(treeFile, "null");
+    }
+    fprintf(treeFile, ",\"traces\":%lu,\"transitions\":%lu,\"time_us\":%lu}",
+            (unsigned long)branch.traces, (unsigned long)branch.transitions,
+            (unsigned long)(mc_total_ns(branch.ns) / 1000));
+  }
+  fprintf(treeFile, "]}\n");
+}
+
+static void
+mc_write_tree_node_dot(long id, size_t depth, const mc_tree_state &state,
+                       const mc_tree_branch &total)
+{
+  fprintf(treeFile,
+          "  n%ld [label=\"depth %zu: %lu enabled, %lu asleep\\n"
+          "%lu traces, %lu transitions\\n%.3f ms, replay %.3f ms\"];\n",
+          id, depth, (unsigned long)state.enabled,
+          (unsigned long)state.asleep, (unsigned long)total.traces,
+          (unsigned long)total.transitions, mc_total_ns(total.ns) / 1e6,
+          state.replayNs / 1e6);
+  for (size_t i = 0; i < state.branches.size(); i++) {
+    const mc_tree_branch &branch = state.branches[i];
+    if (branch.node >= 0) {
+      fprintf(treeFile, "  n%ld -> n%ld", id, branch.node);
+    } else {
+      // Branches ending without branching again end at a point
+      fprintf(treeFile, "  l%ld_%zu [shape=point];\n  n%ld -> l%ld_%zu", id,
+              i, id, id, i);
+    }
+    fprintf(treeFile, " [label=\"thread %lu\\n%lu traces\\n%.3f ms\"];\n",
+            (unsigned long)branch.thread, (unsigned long)branch.traces,
+            mc_total_ns(branch.ns) / 1e6);
+  }
+}
+
+/*
+ * Writes out the deepest state of the current trace if it is a branch
+ * point (or the initial state), and hands what lies beneath it to the
+ * branch of the state above it
+ */
+static void
+mc_close_tree_state()
+{
+  const size_t depth         = treePath.size() - 1;
+  const mc_tree_state &state = treePath.back();
+
+  mc_tree_branch total(TID_INVALID);
+  for (const mc_tree_branch &branch : state.branches) {
+    total.traces += branch.traces;
+    total.transitions += branch.transitions;
+    for (int i = 0; i < MC_PHASE_COUNT; i++) total.ns[i] += branch.ns[i];
+  }
+  if (depth == 0 || state.branches.size() > 1) {
+    total.node = nextNode++;
+    if (treeIsDot) {
+      mc_write_tree_node_dot(total.node, depth, state, total);
+    } else {
+      mc_write_tree_node_json(total.node, depth, state, total);
+    }
+  } else if (!state.branches.empty()) {
+    total.node = state.branches[0].node;
+  }
+  treePath.pop_back();
+  if (treePath.empty()) return;
+
+  mc_tree_branch &above = treePath.back().branches.back();
+  above.node = total.node;
+  above.traces += total.traces;
+  above.transitions += total.transitions;
+  for (int i = 0; i < MC_PHASE_COUNT; i++) above.ns[i] += total.ns[i];
+}
+
+/*
+ * Counts the last trace toward the branch it ended in
+ */
+static void
+mc_flush_tree_trace()
+{
+  if (!traceOpen) return;
+  if (!traceEnded) mc_exploration_tree_end_trace();
+
+  mc_tree_branch &branch = treePath[traceLeaf].branches.back();
+  branch.traces++;
+  branch.transitions += traceTransitions;
+  for (int i = 0; i < MC_PHASE_COUNT; i++) branch.ns[i] += traceNs[i];
+  treePath[traceBranchPoint].replayNs +=
+    traceNs[MC_PHASE_FORK] + traceNs[MC_PHASE_REPLAY];
+  traceOpen = false;
+}
+
+void
+mc_exploration_tree_begin_trace(int branchPoint, tid_t tid)
+{
+  if (treeFile == nullptr) return;
+  mc_flush_tree_trace();
+
+  while (treePath.size() > (size_t)branchPoint + 1) mc_close_tree_state();
+  if (treePath.empty()) treePath.emplace_back();
+
+  mc_tree_state &state = treePath[branchPoint];
+  state.branches.emplace_back(tid);
+  // The thread taken has just left the backtracking set
+  if ((uint64_t)branchPoint < programState->getStateStackSize()) {
+    const uint64_t backtrack =
+      programState->getStateItemAtIndex(branchPoint).getBacktrackSetSize() +
+      1;
+    if (backtrack > state.backtrack) state.backtrack = backtrack;
+  }
+
+  traceOpen        = true;
+  traceEnded       = false;
+  traceBranchPoint = branchPoint;
+  traceLeaf        = branchPoint;
+  traceTransitions = 0;
+  memset(traceNs, 0, sizeof(traceNs));
+}
+
+void
+mc_exploration_tree_end_trace()
+{
+  if (treeFile == nullptr || !traceOpen || traceEnded) return;
+
+  const uint64_t stackSize = programState->getTransitionStackSize();
+  for (uint64_t i = treePath.size(); i < stackSize; i++) {
+    treePath.emplace_back();
+    treePath.back().branches.emplace_back(
+      programState->getThreadRunningTransitionAtIndex(i));
+  }
+  for (uint64_t i = traceBranchPoint; i < stackSize; i++) {
+    mc_tree_state &state = treePath[i];
+    if (state.reached) continue;
+    const MCStackItem &item = programState->getStateItemAtIndex(i);
+    state.reached = true;
+    state.enabled = item.getEnabledThreadsInState().size();
+    state.asleep  = item.getSleepSet().size();
+    // The thread run from the state has since been put to sleep in it
+    // (a thread asleep is never run, so it was not asleep before)
+    if (item.threadIsInSleepSet(
+          programState->getThreadRunningTransitionAtIndex(i)))
+      state.asleep--;
+  }
+  traceLeaf        = treePath.size() - 1;
+  traceTransitions = stackSize > (uint64_t)traceBranchPoint
+                       ? stackSize - traceBranchPoint
+                       : 0;
+  traceEnded       = true;
+}
+
+void
+mc_exploration_tree_add_time(mc_scheduler_phase phase, uint64_t ns)
+{
+  if (treeFile == nullptr || !traceOpen) return;
+  traceNs[phase] += ns;
+}
+
+void
+mc_close_exploration_tree()
+{
+  if (treeFile == nullptr) return;
+  mc_flush_tree_trace();
+  while (!treePath.empty()) mc_close_tree_state();
+  if (treeIsDot) fprintf(treeFile, "}\n");
+  if (fclose(treeFile) != 0) perror("McMini: writing the exploration tree");
+  treeFile = nullptr;
+}
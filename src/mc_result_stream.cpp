@@ -0,0 +1,275 @@
+#include "mc_result_stream.h"
+#include "mc_bug_signatures.h"
+#include "mc_trace_reaper.h"
+#include "mcmini_private.h"
+#include <string>
+
+extern "C" {
+#include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+}
+
+/* The kinds of bugs, as they are named in the stream */
+static const char *const bugKinds[] = {"deadlock", "data_race", "livelock",
+                                       "crash"};
+#define MC_BUG_KIND_COUNT (sizeof(bugKinds) / sizeof(bugKinds[0]))
+
+static int resultFd = -1;
+static uint64_t streamStartNs = 0;
+static uint64_t traceStartNs  = 0;
+static uint64_t bugsInTrace   = 0;
+static uint64_t bugsOfKind[MC_BUG_KIND_COUNT];
+
+static uint64_t
+mc_stream_time()
+{
+  struct timespec now;
+  __real_clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void
+mc_append_json_string(std::string &line, const char *str)
+{
+  line += '"';
+  for (const char *c = str; *c != '\0'; c++) {
+    switch (*c) {
+    case '"':
+      line += "\\\"";
+      break;
+    case '\\':
+      line += "\\\\";
+      break;
+    case '\n':
+      line += "\\n";
+      break;
+    case '\t':
+      line += "\\t";
+      break;
+    default:
+      if ((unsigned char)*c < 0x20) {
+        char escaped[8];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+        line += escaped;
+      } else {
+        line += *c;
+      }
+    }
+  }
+  line += '"';
+}
+
+static void
+mc_append_json_number(std::string &line, const char *name, uint64_t value)
+{
+  line += ",\"";
+  line += name;
+  line += "\":";
+  line += std::to_string(value);
+}
+
+/*
+ * Starts a line of the stream with its event and the time it is
+ * written at
+ */
+static std::string
+mc_begin_event(const char *event)
+{
+  std::string line = "{\"event\":";
+  mc_append_json_string(line, event);
+  mc_append_json_number(line, "time_us",
+                        (mc_stream_time() - streamStartNs) / 1000);
+  return line;
+}
+
+static void
+mc_end_event(std::string &line)
+{
+  line += "}\n";
+  const char *buf = line.c_str();
+  size_t left     = line.size();
+  while (left > 0) {
+    ssize_t rc = write(resultFd, buf, left);
+    if (rc == -1 && errno == EINTR) continue;
+    if (rc <= 0) {
+      // Whoever reads the stream is gone: carry on without it
+      perror("McMini: writing results");
+      resultFd = -1;
+      return;
+    }
+    buf += rc;
+    left -= rc;
+  }
+}
+
+/*
+ * Opens an object for the given transition, with the thread running it
+ * and what it does (see `mc_describe_transition()`)
+ */
+static void
+mc_append_json_transition(std::string &line, const MCTransition &transition)
+{
+  line += "{\"thread\":";
+  line += std::to_string(transition.getThreadId());
+  line += ",\"operation\":";
+  mc_append_json_string(line, mc_describe_transition(transition).c_str());
+}
+
+void
+mc_open_result_stream()
+{
+  const char *value = getenv(ENV_RESULTS_FD);
+  if (value == NULL) return;
+
+  const int fd = (int)strtol(value, nullptr, 10);
+  if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+    fprintf(stderr, "McMini: %s=%s: %s\n", ENV_RESULTS_FD, value,
+            strerror(errno));
+    mc_exit(EXIT_FAILURE);
+  }
+  resultFd      = fd;
+  streamStartNs = mc_stream_time();
+}
+
+void
+mc_stream_trace_start()
+{
+  if (resultFd == -1) return;
+  traceStartNs = mc_stream_time();
+  bugsInTrace  = 0;
+}
+
+void
+mc_stream_trace_outcome(const char *outcome)
+{
+  if (resultFd == -1) return;
+  std::string line = mc_begin_event("trace");
+  mc_append_json_number(line, "trace", traceId);
+  line += ",\"outcome\":";
+  mc_append_json_string(line, outcome);
+  mc_append_json_number(line, "transitions",
+                        programState->getTransitionStackSize());
+  mc_append_json_number(line, "bugs", bugsInTrace);
+  mc_append_json_number(line, "duration_us",
+                        (mc_stream_time() - traceStartNs) / 1000);
+  mc_end_event(line);
+}
+
+void
+mc_stream_bug(const char *kind, tid_t tid, unsigned bugId, bool isNew)
+{
+  if (resultFd == -1) return;
+  bugsInTrace++;
+  for (size_t i = 0; i < MC_BUG_KIND_COUNT; i++)
+    if (strcmp(bugKinds[i], kind) == 0) bugsOfKind[i]++;
+
+  std::string line = mc_begin_event("bug");
+  line += ",\"kind\":";
+  mc_append_json_string(line, kind);
+  mc_append_json_number(line, "trace", traceId);
+  if (tid != TID_INVALID) mc_append_json_number(line, "thread", tid);
+  mc_append_json_number(line, "bug", bugId);
+  char signature[20];
+  snprintf(signature, sizeof(signature), "%016lx",
+           (unsigned long)mc_bug_signature_hash(bugId));
+  line += ",\"signature\":";
+  mc_append_json_string(line, signature);
+  line += ",\"new\":";
+  line += isNew ? "true" : "false";
+  if (!isNew) {
+    mc_end_event(line);
+    return;
+  }
+
+  const int stackSize = (int)programState->getTransitionStackSize();
+  line += ",\"schedule\":[";
+  for (int i = 0; i < stackSize; i++) {
+    if (i > 0) line += ',';
+    line += std::to_string(programState->getThreadRunningTransitionAtIndex(i));
+  }
+  line += "],\"backtrace\":[";
+  for (int i = 0; i < stackSize; i++) {
+    if (i > 0) line += ',';
+    mc_append_json_transition(line, programState->getTransitionAtIndex(i));
+    line += '}';
+  }
+  line += "],\"pending\":[";
+  const uint64_t numThreads = programState->getNumProgramThreads();
+  for (uint64_t i = 0; i < numThreads; i++) {
+    const MCTransition &next = programState->getNextTransitionForThread(i);
+    if (i > 0) line += ',';
+    mc_append_json_transition(line, next);
+    line += ",\"enabled\":";
+    line += next.threadIsEnabled() && next.enabledInState(programState.get())
+              ? "true"
+              : "false";
+    line += '}';
+  }
+  line += ']';
+  mc_end_event(line);
+}
+
+void
+mc_stream_progress()
+{
+  if (resultFd == -1) return;
+  std::string line = mc_begin_event("progress");
+  mc_append_json_number(line, "traces", traceId);
+  mc_append_json_number(line, "transitions", transitionId);
+  mc_end_event(line);
+}
+
+/*
+ * The peak resident set size of the scheduler. Unlike that given by
+ * `getrusage()`, it does not carry over that of whatever process
+ * exec()ed McMini
+ */
+static long
+mc_scheduler_max_rss_kb()
+{
+  FILE *status = fopen("/proc/self/status", "r");
+  if (status == NULL) return 0;
+  long kb    = 0;
+  char *line = nullptr;
+  size_t size = 0;
+  while (getline(&line, &size, status) != -1)
+    if (sscanf(line, "VmHWM: %ld kB", &kb) == 1) break;
+  free(line);
+  fclose(status);
+  return kb;
+}
+
+void
+mc_stream_summary(uint64_t tracesOverBudget, uint64_t tracesDiverged)
+{
+  if (resultFd == -1) return;
+  std::string line = mc_begin_event("summary");
+  mc_append_json_number(line, "traces", traceId);
+  mc_append_json_number(line, "transitions", transitionId);
+  mc_append_json_number(line, "traces_over_budget", tracesOverBudget);
+  mc_append_json_number(line, "traces_diverged", tracesDiverged);
+  mc_append_json_number(line, "distinct_bugs", mc_distinct_bug_count());
+  mc_append_json_number(line, "max_rss_kb", mc_scheduler_max_rss_kb());
+  // Traces are adopted by the scheduler (see `mc_spawn_trace_template()`)
+  // and so count among its children once reaped
+  mc_drain_trace_reaper();
+  struct rusage usage;
+  getrusage(RUSAGE_CHILDREN, &usage);
+  mc_append_json_number(line, "trace_max_rss_kb", usage.ru_maxrss);
+  line += ",\"bugs\":{";
+  for (size_t i = 0; i < MC_BUG_KIND_COUNT; i++) {
+    if (i > 0) line += ',';
+    mc_append_json_string(line, bugKinds[i]);
+    line += ':';
+    line += std::to_string(bugsOfKind[i]);
+  }
+  line += '}';
+  mc_end_event(line);
+}
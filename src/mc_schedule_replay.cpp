@@ -0,0 +1,200 @@
+#include "mc_schedule_replay.h"
+#include "mc_bug_signatures.h"
+#include "mc_result_stream.h"
+#include "mc_trace_output.h"
+#include "mcmini_private.h"
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+}
+
+struct mc_replay_step {
+  tid_t tid;
+  // What the thread is expected to run, as `mc_describe_transition()`
+  // tells it, or empty if not known
+  std::string operation;
+};
+
+/*
+ * Reads a step from a line of a THREAD BACKTRACE, e.g.
+ * " 3. thread 1: pthread_mutex_lock(mut:2)"
+ */
+static bool
+mc_parse_backtrace_line(const char *line, mc_replay_step &step)
+{
+  int number;
+  int start = -1;
+  unsigned long tid;
+  if (sscanf(line, " %d. %nthread %lu:", &number, &start, &tid) != 2)
+    return false;
+
+  std::string operation = line + start;
+  while (!operation.empty() && isspace((unsigned char)operation.back()))
+    operation.pop_back();
+  step.tid       = (tid_t)tid;
+  step.operation = operation;
+  return true;
+}
+
+/*
+ * Reads the thread ids of a line holding nothing else, adding a step
+ * for each
+ */
+static bool
+mc_parse_schedule_line(const char *line, std::vector<mc_replay_step> &steps)
+{
+  if (line[strspn(line, "0123456789, \t\r\n")] != '\0' ||
+      strpbrk(line, "0123456789") == nullptr)
+    return false;
+
+  const char *c = line;
+  while (*c != '\0') {
+    if (*c < '0' || *c > '9') {
+      c++;
+      continue;
+    }
+    char *end;
+    steps.push_back(mc_replay_step{(tid_t)strtoul(c, &end, 10), ""});
+    c = end;
+  }
+  return true;
+}
+
+/*
+ * Reads a schedule from the given lines. The steps of a THREAD
+ * BACKTRACE, if any, take the place of the lines of thread ids (the
+ * backtrace itself ends with such a line); only the first backtrace
+ * counts
+ */
+static void
+mc_parse_schedule(FILE *lines, std::vector<mc_replay_step> &steps)
+{
+  std::vector<mc_replay_step> backtrace;
+  char *line = nullptr;
+  size_t size = 0;
+  while (getline(&line, &size, lines) != -1) {
+    mc_replay_step step;
+    if (mc_parse_backtrace_line(line, step)) {
+      backtrace.push_back(step);
+    } else if (!backtrace.empty() && strncmp(line, "END", 3) == 0) {
+      break;
+    } else {
+      mc_parse_schedule_line(line, steps);
+    }
+  }
+  free(line);
+  if (!backtrace.empty()) steps = backtrace;
+}
+
+bool
+mc_schedule_to_replay_given()
+{
+  return getenv(ENV_REPLAY) != NULL || getenv(ENV_REPLAY_FILE) != NULL;
+}
+
+/*
+ * Ends a replay which cannot go on as the schedule says at the given
+ * step
+ */
+static void
+mc_stop_replay_at_step(size_t step, const char *why)
+{
+  mcprintf("*** REPLAY STOPPED at step %lu ***\n%s",
+           (unsigned long)step + 1, why);
+  programState->printTransitionStack();
+  programState->printNextTransitions();
+  mc_print_trace_output();
+  mc_stream_trace_outcome("diverged");
+  mc_terminate_trace();
+  traceId++;
+  mc_stream_summary(0, 1);
+  mc_stop_model_checking(EXIT_FAILURE);
+}
+
+void
+mc_replay_schedule()
+{
+  std::vector<mc_replay_step> steps;
+  const char *path = getenv(ENV_REPLAY_FILE);
+  FILE *lines      = path != NULL
+                       ? fopen(path, "r")
+                       : fmemopen((void *)getenv(ENV_REPLAY),
+                                  strlen(getenv(ENV_REPLAY)), "r");
+  if (lines == NULL) {
+    fprintf(stderr, "McMini: %s: %s\n", path != NULL ? path : ENV_REPLAY,
+            strerror(errno));
+    mc_stop_model_checking(EXIT_FAILURE);
+  }
+  mc_parse_schedule(lines, steps);
+  fclose(lines);
+  if (steps.empty()) {
+    fprintf(stderr, "McMini: no schedule to replay in %s\n",
+            path != NULL ? path : ENV_REPLAY);
+    mc_stop_model_checking(EXIT_FAILURE);
+  }
+
+  mc_prepare_to_model_check_new_program();
+  mc_stream_trace_start();
+  mc_fork_new_trace();
+
+  char why[1000];
+  for (size_t i = 0; i < steps.size(); i++) {
+    const mc_replay_step &step = steps[i];
+    if (step.tid >= programState->getNumProgramThreads()) {
+      snprintf(why, sizeof(why), "  (thread %lu does not exist)\n",
+               (unsigned long)step.tid);
+      mc_stop_replay_at_step(i, why);
+    }
+
+    const MCTransition &next =
+      programState->getNextTransitionForThread(step.tid);
+    if (!step.operation.empty()) {
+      const std::string operation = mc_describe_transition(next);
+      if (operation != step.operation) {
+        snprintf(why, sizeof(why), "  (expected: %s\n   found:    %s)\n",
+                 step.operation.c_str(), operation.c_str());
+        mc_stop_replay_at_step(i, why);
+      }
+    }
+    if (!MCTransition::transitionEnabledInState(programState.get(), next)) {
+      snprintf(why, sizeof(why), "  (thread %lu cannot run)\n",
+               (unsigned long)step.tid);
+      mc_stop_replay_at_step(i, why);
+    }
+
+    transitionId++;
+    if (!mc_run_thread_to_next_visible_operation(step.tid)) {
+      // The thread went over budget, which has been reported
+      traceId++;
+      mc_stream_summary(1, 0);
+      mc_stop_model_checking(EXIT_FAILURE);
+    }
+    programState->replayRunningTransition(next, shmTransitionTypeInfo,
+                                          shmTransitionData);
+  }
+
+  const bool hasDeadlock = programState->isInDeadlock();
+  if (hasDeadlock) {
+    bool newBug;
+    const unsigned bugId = mc_classify_bug("deadlock", TID_INVALID, &newBug);
+    mc_stream_bug("deadlock", TID_INVALID, bugId, newBug);
+    mcprintf("TraceId %lu, *** DEADLOCK DETECTED ***\n", traceId);
+  } else {
+    mcprintf("*** Replayed all %lu steps of the schedule ***\n",
+             (unsigned long)steps.size());
+  }
+  programState->printTransitionStack();
+  programState->printNextTransitions();
+  mc_print_trace_output();
+  mc_stream_trace_outcome(hasDeadlock ? "deadlock" : "ok");
+  mc_terminate_trace();
+  traceId++;
+  mc_stream_summary(0, 0);
+  mc_stop_model_checking(EXIT_SUCCESS);
+}
@@ -0,0 +1,157 @@
+#include "mc_scheduler_profile.h"
+#include "MCEnv.h"
+#include "mc_exploration_tree.h"
+
+extern "C" {
+#include "MCCommon.h"
+#include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <stdlib.h>
+#include <time.h>
+}
+
+/* One bucket per power of two of nanoseconds */
+#define MC_PHASE_HISTOGRAM_BUCKETS (64)
+
+struct mc_phase_profile {
+  uint64_t count;
+  uint64_t totalNs;
+  uint64_t maxNs;
+  uint64_t histogram[MC_PHASE_HISTOGRAM_BUCKETS];
+};
+
+static const char *const phaseNames[MC_PHASE_COUNT] = {
+  "fork", "replay", "step", "simulate", "backtrack", "checks", "teardown"};
+
+static mc_phase_profile phases[MC_PHASE_COUNT];
+static bool profiling = false;
+
+/* Whether phases are timed, for the profile or for the exploration tree
+ * (see `mc_open_exploration_tree()`) */
+static bool timing = false;
+
+static uint64_t profileStartNs = 0;
+static uint64_t reportIntervalNs = 0; // 0 if only printed at exit
+static uint64_t nextReportNs = 0;
+
+static uint64_t
+mc_profile_time()
+{
+  // The scheduler's clocks are not virtualized, but the wrapper is
+  // better left out of what is timed
+  struct timespec now;
+  __real_clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static int
+mc_histogram_bucket(uint64_t ns)
+{
+  return ns == 0 ? 0 : 63 - __builtin_clzl(ns);
+}
+
+/*
+ * Prints a duration in nanoseconds in the unit which suits it
+ */
+static void
+mc_print_duration(uint64_t ns)
+{
+  if (ns < 1000) {
+    mcprintf("%luns", (unsigned long)ns);
+  } else if (ns < 1000 * 1000) {
+    mcprintf("%luus", (unsigned long)(ns / 1000));
+  } else if (ns < 1000ul * 1000 * 1000) {
+    mcprintf("%lums", (unsigned long)(ns / (1000 * 1000)));
+  } else {
+    mcprintf("%lus", (unsigned long)(ns / (1000ul * 1000 * 1000)));
+  }
+}
+
+void
+mc_start_scheduler_profile()
+{
+  const char *value = getenv(ENV_PROFILE);
+  timing = value != NULL || getenv(ENV_EXPLORATION_TREE) != NULL;
+  if (value == NULL) return;
+
+  profiling      = true;
+  profileStartNs = mc_profile_time();
+  reportIntervalNs =
+    strtoul(value, nullptr, 10) * 1000ul * 1000 * 1000;
+  nextReportNs = profileStartNs + reportIntervalNs;
+}
+
+uint64_t
+mc_begin_phase()
+{
+  return timing ? mc_profile_time() : 0;
+}
+
+void
+mc_end_phase(mc_scheduler_phase phase, uint64_t begin)
+{
+  if (!timing) return;
+
+  const uint64_t now      = mc_profile_time();
+  const uint64_t duration = now - begin;
+  mc_exploration_tree_add_time(phase, duration);
+  if (!profiling) return;
+
+  mc_phase_profile *p     = &phases[phase];
+  p->count++;
+  p->totalNs += duration;
+  if (duration > p->maxNs) p->maxNs = duration;
+  p->histogram[mc_histogram_bucket(duration)]++;
+
+  if (reportIntervalNs != 0 && now >= nextReportNs) {
+    nextReportNs = now + reportIntervalNs;
+    mc_print_scheduler_profile();
+  }
+}
+
+const char *
+mc_scheduler_phase_name(mc_scheduler_phase phase)
+{
+  return phaseNames[phase];
+}
+
+void
+mc_print_scheduler_profile()
+{
+  if (!profiling) return;
+
+  const uint64_t elapsedNs = mc_profile_time() - profileStartNs;
+  uint64_t timedNs         = 0;
+  for (const mc_phase_profile &p : phases) timedNs += p.totalNs;
+
+  mcprintf("*** Scheduler profile (%.3f s) ***\n", elapsedNs / 1e9);
+  mcprintf("  %-10s %10s %12s %7s %10s %10s\n", "phase", "count",
+           "total (ms)", "share", "mean (us)", "max (us)");
+  for (int i = 0; i < MC_PHASE_COUNT; i++) {
+    const mc_phase_profile &p = phases[i];
+    mcprintf("  %-10s %10lu %12.3f %6.1f%% %10.3f %10.3f\n", phaseNames[i],
+             (unsigned long)p.count, p.totalNs / 1e6,
+             elapsedNs ? 100.0 * p.totalNs / elapsedNs : 0.0,
+             p.count ? p.totalNs / 1e3 / p.count : 0.0, p.maxNs / 1e3);
+  }
+  // Whatever is left is spent between phases: choosing branches,
+  // reporting, and the like
+  const uint64_t otherNs = elapsedNs > timedNs ? elapsedNs - timedNs : 0;
+  mcprintf("  %-10s %10s %12.3f %6.1f%%\n", "(other)", "", otherNs / 1e6,
+           elapsedNs ? 100.0 * otherNs / elapsedNs : 0.0);
+
+  // Each bucket counts the times of at least its bound and less than
+  // twice its bound
+  mcprintf("  Histograms (count of times >= bucket):\n");
+  for (int i = 0; i < MC_PHASE_COUNT; i++) {
+    const mc_phase_profile &p = phases[i];
+    if (p.count == 0) continue;
+    mcprintf("  %-10s", phaseNames[i]);
+    for (int b = 0; b < MC_PHASE_HISTOGRAM_BUCKETS; b++) {
+      if (p.histogram[b] == 0) continue;
+      mcprintf(" ");
+      mc_print_duration(1ul << b);
+      mcprintf(":%lu", (unsigned long)p.histogram[b]);
+    }
+    mcprintf("\n");
+  }
+}
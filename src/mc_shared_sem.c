@@ -1,5 +1,8 @@
+#define _GNU_SOURCE
 #include "mc_shared_sem.h"
 #include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <errno.h>
+#include <time.h>
 
 // PRETTY_PRINT_DEF_DECL(mc_shared_sem)
 
@@ -9,6 +12,8 @@ mc_shared_sem_init(mc_shared_sem_ref ref)
   if (!ref) return;
   __real_sem_init(&ref->dpor_scheduler_sem, SEM_FLAG_SHARED, 0);
   __real_sem_init(&ref->pthread_sem, SEM_FLAG_SHARED, 0);
+  ref->reached_type   = 0;
+  ref->reached_object = 0;
 }
 
 void
@@ -24,7 +29,22 @@ mc_shared_sem_destroy(mc_shared_sem_ref ref)
 void
 mc_shared_sem_wait_for_thread(mc_shared_sem_ref ref)
 {
-  __real_sem_wait(&ref->dpor_scheduler_sem);
+  // sem_wait(3) is never restarted after a signal handler runs, and the
+  // scheduler handles SIGCHLD for traces exiting in the background
+  while (__real_sem_wait(&ref->dpor_scheduler_sem) == -1 && errno == EINTR)
+    ;
+}
+
+int
+mc_shared_sem_wait_for_thread_until(mc_shared_sem_ref ref,
+                                    const struct timespec *deadline)
+{
+  int rc;
+  while ((rc = sem_clockwait(&ref->dpor_scheduler_sem, CLOCK_MONOTONIC,
+                             deadline)) == -1 &&
+         errno == EINTR)
+    ;
+  return rc;
 }
 
 static void mc_shared_sem_wait_for_scheduler_done() {
@@ -32,7 +52,8 @@ static void mc_shared_sem_wait_for_scheduler_done() {
 void
 mc_shared_sem_wait_for_scheduler(mc_shared_sem_ref ref)
 {
-  __real_sem_wait(&ref->pthread_sem);
+  while (__real_sem_wait(&ref->pthread_sem) == -1 && errno == EINTR)
+    ;
   // We have this for gdbinit_command: mcmini forward
   mc_shared_sem_wait_for_scheduler_done();
 }
@@ -0,0 +1,134 @@
+#include "mc_trace_output.h"
+#include "mcmini_private.h"
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+/* How many steps pass between looks at the size of a trace's output */
+#define MC_TRACE_OUTPUT_TRIM_INTERVAL (256)
+
+/* The buffer of each generation of the sleep list, or -1 if the output
+ * of traces is not captured */
+static int traceOutputs[TRACE_SLEEP_LIST_GENERATIONS];
+
+static unsigned stepsSinceTrim = 0;
+
+void
+mc_create_trace_outputs()
+{
+  for (int i = 0; i < TRACE_SLEEP_LIST_GENERATIONS; i++) traceOutputs[i] = -1;
+  if (getenv(ENV_NO_OUTPUT_CAPTURE) != NULL || getenv(ENV_QUIET) != NULL)
+    return;
+
+  for (int i = 0; i < TRACE_SLEEP_LIST_GENERATIONS; i++) {
+    int fd = memfd_create("mcmini-trace-output", MFD_CLOEXEC);
+    if (fd == -1) {
+      perror("memfd_create");
+      mc_exit(EXIT_FAILURE);
+    }
+    // All traces using the buffer share the offset at which they write:
+    // let each write go to the end of the buffer wherever that is
+    if (fcntl(fd, F_SETFL, O_APPEND) == -1) {
+      perror("fcntl");
+      mc_exit(EXIT_FAILURE);
+    }
+    traceOutputs[i] = fd;
+  }
+}
+
+void
+mc_capture_trace_output()
+{
+  const int output = traceOutputs[trace_sleep_list_generation];
+  if (output == -1) return;
+
+  fflush(stdout);
+  fflush(stderr);
+  dup2(output, STDOUT_FILENO);
+  dup2(output, STDERR_FILENO);
+
+  // Output to a file is otherwise fully buffered, and a trace is
+  // usually killed before it gets to flush it. Whatever the target has
+  // printed by the time the trace is reported must be in the buffer,
+  // partial lines included
+  setvbuf(stdout, nullptr, _IONBF, 0);
+}
+
+void
+mc_reset_trace_output(unsigned generation)
+{
+  const int output = traceOutputs[generation];
+  if (output == -1) return;
+  if (ftruncate(output, 0) == -1) perror("ftruncate");
+  stepsSinceTrim = 0;
+}
+
+void
+mc_trim_trace_output()
+{
+  const int output = traceOutputs[trace_sleep_list_generation];
+  if (output == -1 || ++stepsSinceTrim < MC_TRACE_OUTPUT_TRIM_INTERVAL)
+    return;
+  stepsSinceTrim = 0;
+
+  struct stat st;
+  if (fstat(output, &st) == -1 ||
+      (uint64_t)st.st_size <= 2 * MC_TRACE_OUTPUT_CAPACITY)
+    return;
+
+  // Only the end of the output is ever read: the memory behind the rest
+  // can go, leaving a hole in its place
+  const off_t end = st.st_size - (off_t)MC_TRACE_OUTPUT_CAPACITY;
+  fallocate(output, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0,
+            end & ~(off_t)(SHARED_MEMORY_PAGE_SIZE - 1));
+}
+
+void
+mc_print_trace_output()
+{
+  const int output = traceOutputs[trace_sleep_list_generation];
+  if (output == -1) return;
+
+  struct stat st;
+  if (fstat(output, &st) == -1 || st.st_size == 0) return;
+
+  off_t offset = 0;
+  if ((uint64_t)st.st_size > MC_TRACE_OUTPUT_CAPACITY)
+    offset = st.st_size - (off_t)MC_TRACE_OUTPUT_CAPACITY;
+
+  mcprintf("TRACE OUTPUT\n");
+
+  char buf[4096];
+  bool endsInNewline = true;
+  bool skipPartialLine = offset > 0;
+  for (;;) {
+    ssize_t rc = pread(output, buf, sizeof(buf), offset);
+    if (rc == -1 && errno == EINTR) continue;
+    if (rc <= 0) break;
+    offset += rc;
+
+    const char *start = buf;
+    if (skipPartialLine) {
+      // Start with the first whole line kept
+      const char *newline = (const char *)memchr(buf, '\n', rc);
+      if (newline != nullptr) start = newline + 1;
+      mcprintf("[... %lu bytes left out ...]\n",
+               (unsigned long)(offset - rc + (start - buf)));
+      skipPartialLine = false;
+    }
+    const int len = (int)(buf + rc - start);
+    if (len == 0) continue;
+    mcprintf("%.*s", len, start);
+    endsInNewline = start[len - 1] == '\n';
+  }
+  if (!endsInNewline) mcprintf("\n");
+  mcprintf("END\n");
+}
@@ -0,0 +1,211 @@
+#include "mc_trace_pipeline.h"
+#include "mc_trace_reaper.h"
+#include "mc_trace_watchdog.h"
+#include "mcmini_private.h"
+#include <vector>
+
+extern "C" {
+#include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+}
+
+/* How long a replaying thread waits on a step before making sure its
+ * trace is still there */
+#define MC_PREPARED_TRACE_POLL_NS (100ul * 1000 * 1000)
+
+/*
+ * A trace replayed ahead of time, and the thread replaying it. The
+ * scheduler hands the thread a branch on `start`; the thread posts to
+ * `replayed` once it is done with it
+ */
+struct mc_prepared_trace {
+  int branchPoint; // FIRST_BRANCH while the thread is free
+  pid_t pid;
+  int pidfd;
+  unsigned generation;
+  std::vector<tid_t> prefix;
+  std::vector<uint64_t> checksums;
+  mc_reached_objects objects;
+  bool succeeded;
+  sem_t start;
+  sem_t replayed;
+};
+
+/*
+ * NOTE: Allocated when pipelining starts: `mcmini_main()` is itself a
+ * constructor and may run before the constructors of this file
+ */
+static mc_prepared_trace *preparedTraces = nullptr;
+static int preparedTraceCount            = 0;
+
+static mc_prepared_trace *
+mc_find_prepared_trace(int branchPoint)
+{
+  for (int i = 0; i < preparedTraceCount; i++)
+    if (preparedTraces[i].branchPoint == branchPoint)
+      return &preparedTraces[i];
+  return nullptr;
+}
+
+/*
+ * Waits for a thread of a trace replayed ahead of time to reach its
+ * next visible operation, returning false if the trace exits first
+ */
+static bool
+mc_wait_for_prepared_thread(const mc_prepared_trace *trace,
+                            mc_shared_sem_ref sem)
+{
+  for (;;) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_nsec += MC_PREPARED_TRACE_POLL_NS;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000;
+    deadline.tv_nsec %= 1000000000;
+    if (mc_shared_sem_wait_for_thread_until(sem, &deadline) == 0)
+      return true;
+
+    struct pollfd exited;
+    exited.fd     = trace->pidfd;
+    exited.events = POLLIN;
+    if (poll(&exited, 1, 0) != 0) return false;
+  }
+}
+
+static bool
+mc_replay_prepared_trace(mc_prepared_trace *trace)
+{
+  uint64_t checksum = 0;
+  trace->objects.ordinals.clear();
+  for (size_t i = 0; i < trace->prefix.size(); i++) {
+    const tid_t tid = trace->prefix[i];
+    mc_shared_sem_ref sem =
+      mc_trace_sleep_list_slot_of_generation(tid, trace->generation);
+    mc_shared_sem_wake_thread(sem);
+    if (!mc_wait_for_prepared_thread(trace, sem)) return false;
+
+    checksum = mc_checksum_step(checksum, tid, sem, trace->objects);
+    if (checksum != trace->checksums[i]) return false;
+  }
+  return true;
+}
+
+static void *
+mc_run_trace_replayer(void *arg)
+{
+  mc_prepared_trace *trace = (mc_prepared_trace *)arg;
+  for (;;) {
+    while (__real_sem_wait(&trace->start) == -1 && errno == EINTR)
+      ;
+    trace->succeeded = mc_replay_prepared_trace(trace);
+    __real_sem_post(&trace->replayed);
+  }
+  return nullptr;
+}
+
+static void
+mc_discard_prepared_trace(mc_prepared_trace *trace)
+{
+  // As with the current trace (see `mc_terminate_trace()`)
+  const int lastUser = mc_reap_trace_in_background(trace->pid, traceId);
+  kill(trace->pid, SIGUSR1);
+  if (lastUser == -1) waitpid(trace->pid, nullptr, 0);
+  close(trace->pidfd);
+  mc_release_trace_sleep_list_generation(trace->generation, lastUser);
+}
+
+void
+mc_start_trace_pipeline()
+{
+  const char *value = getenv(ENV_LIVE_TRACES);
+  if (value == NULL || mc_has_trace_budgets() ||
+      getenv(ENV_PRINT_AT_TRACE_SEQ) != NULL)
+    return;
+
+  long liveTraces = strtol(value, nullptr, 10);
+  if (liveTraces > MAX_LIVE_TRACES) liveTraces = MAX_LIVE_TRACES;
+  if (liveTraces < 2) return;
+
+  preparedTraceCount = (int)liveTraces - 1;
+  preparedTraces     = new mc_prepared_trace[preparedTraceCount];
+
+  // Signals meant for the scheduler must not be handled by the
+  // replaying threads
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  for (int i = 0; i < preparedTraceCount; i++) {
+    mc_prepared_trace *trace = &preparedTraces[i];
+    trace->branchPoint       = FIRST_BRANCH;
+    __real_sem_init(&trace->start, 0, 0);
+    __real_sem_init(&trace->replayed, 0, 0);
+
+    pthread_t replayer;
+    int rc = __real_pthread_create(&replayer, nullptr, &mc_run_trace_replayer,
+                                   trace);
+    if (rc != 0) {
+      errno = rc;
+      perror("pthread_create");
+      mc_exit(EXIT_FAILURE);
+    }
+  }
+  pthread_sigmask(SIG_SETMASK, &old, nullptr);
+}
+
+bool
+mc_adopt_prepared_trace(int branchPoint)
+{
+  mc_prepared_trace *trace = mc_find_prepared_trace(branchPoint);
+  if (trace == nullptr) return false;
+
+  while (__real_sem_wait(&trace->replayed) == -1 && errno == EINTR)
+    ;
+  trace->branchPoint = FIRST_BRANCH;
+  if (!trace->succeeded) {
+    mc_discard_prepared_trace(trace);
+    return false;
+  }
+  close(trace->pidfd);
+  mc_adopt_trace(trace->pid, trace->generation, trace->objects);
+  return true;
+}
+
+void
+mc_prepare_traces_ahead(int branchPoint)
+{
+  // Replaying up to the initial state takes no more than a fork
+  for (int j = branchPoint; j > 0; j--) {
+    mc_prepared_trace *trace = mc_find_prepared_trace(FIRST_BRANCH);
+    if (trace == nullptr) return;
+    if (!programState->getStateItemAtIndex(j).hasThreadsToBacktrackOn() ||
+        mc_find_prepared_trace(j) != nullptr)
+      continue;
+
+    trace->generation = mc_claim_trace_sleep_list_generation();
+    trace->pid        = mc_fork_trace_process(trace->generation);
+    trace->pidfd      = mc_pidfd_open(trace->pid);
+    if (trace->pidfd == -1) {
+      // Without a pidfd, the replaying thread could not tell whether
+      // the trace is still there
+      kill(trace->pid, SIGUSR1);
+      waitpid(trace->pid, nullptr, 0);
+      mc_release_trace_sleep_list_generation(trace->generation, -1);
+      return;
+    }
+
+    trace->prefix.resize(j);
+    trace->checksums.resize(j);
+    for (int i = 0; i < j; i++) {
+      trace->prefix[i]    = programState->getThreadRunningTransitionAtIndex(i);
+      trace->checksums[i] = mc_step_checksum(i);
+    }
+    trace->branchPoint = j;
+    __real_sem_post(&trace->start);
+  }
+}
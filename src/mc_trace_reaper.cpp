@@ -0,0 +1,280 @@
+#include "mc_trace_reaper.h"
+#include "mcmini_private.h"
+#include <atomic>
+
+extern "C" {
+#include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+}
+
+/* The epoll set of the pidfds of the traces left to reap, or -1 if there
+ * is no reaper */
+static int reaperEpoll = -1;
+
+/* The number of traces handed to the reaper not yet reaped */
+static std::atomic<int> tracesLeftToReap{0};
+
+/* Signaled each time the count of traces left to reap drops to zero */
+static int reaperDrained = -1;
+
+/*
+ * A trace watched by the reaper. Allocated by the scheduler and freed by
+ * the reaper once the trace is collected
+ */
+struct mc_reaped_trace {
+  pid_t pid;
+  int pidfd;
+  trid_t traceId;
+};
+
+/*
+ * The trace the scheduler is running, as long as it has not been handed
+ * over to be reaped. Whichever of the scheduler (terminating the trace)
+ * and the reaper (seeing it exit) first takes the trace out of here
+ * decides whether its exit was expected
+ */
+static std::atomic<mc_reaped_trace *> supervisedTrace{nullptr};
+
+/*
+ * The process id of the last trace the scheduler had the reaper
+ * supervise. Only the scheduler reads it: the trace itself may be freed
+ * by the reaper at any moment, and is never dereferenced by the
+ * scheduler once published in `supervisedTrace`
+ */
+static pid_t supervisedPid = -1;
+
+int
+mc_pidfd_open(pid_t pid)
+{
+  return (int)syscall(SYS_pidfd_open, pid, 0);
+}
+
+/*
+ * Takes a trace off the count of those left to reap, waking up the
+ * scheduler if it is draining the reaper and that was the last one
+ */
+static void
+mc_count_trace_reaped()
+{
+  if (--tracesLeftToReap == 0) {
+    const uint64_t one = 1;
+    write(reaperDrained, &one, sizeof(one));
+  }
+}
+
+static void *
+mc_run_trace_reaper(void *)
+{
+  struct epoll_event events[16];
+  for (;;) {
+    int n = epoll_wait(reaperEpoll, events, 16, -1);
+    for (int i = 0; i < n; i++) {
+      mc_reaped_trace *trace = (mc_reaped_trace *)events[i].data.ptr;
+
+      // A pidfd becomes readable once its process has exited, so the
+      // trace is a zombie and the call returns at once
+      int status;
+      pid_t rc;
+      while ((rc = waitpid(trace->pid, &status, 0)) == -1 && errno == EINTR)
+        ;
+      if (rc == trace->pid) mc_report_trace_exit(trace->traceId, status);
+
+      mc_reaped_trace *expected = trace;
+      if (supervisedTrace.compare_exchange_strong(expected, nullptr)) {
+        // A ^C reaches the traces as well as the scheduler, which
+        // reports the interruption itself
+        if (rc != trace->pid ||
+            !(WIFSIGNALED(status) && WTERMSIG(status) == SIGINT))
+          mc_notify_trace_stopped_early();
+      } else {
+        mc_count_trace_reaped();
+      }
+
+      // Closing the pidfd also removes it from the epoll set
+      close(trace->pidfd);
+      free(trace);
+    }
+  }
+  return nullptr;
+}
+
+/*
+ * Adds the trace with the given process id to the traces watched by the
+ * reaper, marking it as the trace the scheduler is running if
+ * `supervise` is set
+ */
+static bool
+mc_watch_trace(pid_t pid, trid_t id, bool supervise)
+{
+  int pidfd = mc_pidfd_open(pid);
+  if (pidfd == -1) return false;
+
+  mc_reaped_trace *trace =
+    (mc_reaped_trace *)malloc(sizeof(mc_reaped_trace));
+  if (trace == nullptr) {
+    close(pidfd);
+    return false;
+  }
+  trace->pid     = pid;
+  trace->pidfd   = pidfd;
+  trace->traceId = id;
+
+  struct epoll_event event;
+  event.events   = EPOLLIN | EPOLLONESHOT;
+  event.data.ptr = trace;
+  if (supervise) {
+    supervisedPid   = pid;
+    supervisedTrace = trace;
+  } else {
+    tracesLeftToReap++;
+  }
+  if (epoll_ctl(reaperEpoll, EPOLL_CTL_ADD, pidfd, &event) == -1) {
+    if (supervise) {
+      supervisedTrace = nullptr;
+    } else {
+      mc_count_trace_reaped();
+    }
+    close(pidfd);
+    free(trace);
+    return false;
+  }
+  return true;
+}
+
+bool
+mc_start_trace_reaper()
+{
+  if (getenv(ENV_NO_TRACE_REAPER) != NULL) return false;
+
+  // Probe for pidfd support (Linux 5.3)
+  int pidfd = mc_pidfd_open(getpid());
+  if (pidfd == -1) return false;
+  close(pidfd);
+
+  reaperEpoll = epoll_create1(EPOLL_CLOEXEC);
+  if (reaperEpoll == -1) {
+    perror("epoll_create1");
+    mc_exit(EXIT_FAILURE);
+  }
+  reaperDrained = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (reaperDrained == -1) {
+    perror("eventfd");
+    mc_exit(EXIT_FAILURE);
+  }
+
+  // Signals meant for the scheduler must not be handled by the reaper
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  pthread_t reaper;
+  int rc = __real_pthread_create(&reaper, nullptr, &mc_run_trace_reaper,
+                                 nullptr);
+  pthread_sigmask(SIG_SETMASK, &old, nullptr);
+  if (rc != 0) {
+    errno = rc;
+    perror("pthread_create");
+    mc_exit(EXIT_FAILURE);
+  }
+  return true;
+}
+
+void
+mc_supervise_trace(pid_t pid, trid_t id)
+{
+  if (reaperEpoll == -1) return;
+  mc_watch_trace(pid, id, true);
+}
+
+int
+mc_reap_trace_in_background(pid_t pid, trid_t id)
+{
+  if (reaperEpoll == -1) return -1;
+
+  // The reaper and the scheduler each get their own pidfd so that
+  // neither has to care when the other closes its own
+  int callerPidfd = mc_pidfd_open(pid);
+  if (callerPidfd == -1) return -1;
+
+  // The reaper is already watching the trace if it is supervised. Only
+  // the scheduler publishes traces in `supervisedTrace`, so the one found
+  // there is that of `supervisedPid` unless the reaper has taken it
+  // The trace is counted first, lest the reaper count it as reaped
+  // before it is counted at all
+  tracesLeftToReap++;
+  mc_reaped_trace *trace = supervisedTrace;
+  if (trace != nullptr && supervisedPid == pid &&
+      supervisedTrace.compare_exchange_strong(trace, nullptr)) {
+    return callerPidfd;
+  }
+  mc_count_trace_reaped();
+  if (!mc_watch_trace(pid, id, false)) {
+    close(callerPidfd);
+    return -1;
+  }
+  return callerPidfd;
+}
+
+bool
+mc_expect_supervised_trace_exit()
+{
+  if (reaperEpoll == -1) return false;
+
+  // Whichever trace is supervised, it is the one the scheduler runs
+  tracesLeftToReap++;
+  if (supervisedTrace.exchange(nullptr) != nullptr) return true;
+  mc_count_trace_reaped();
+  return false;
+}
+
+void
+mc_await_trace_exit(int pidfd)
+{
+  struct pollfd exited;
+  exited.fd     = pidfd;
+  exited.events = POLLIN;
+  while (poll(&exited, 1, -1) == -1 && errno == EINTR)
+    ;
+  close(pidfd);
+}
+
+static uint64_t
+mc_monotonic_ns()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ul + (uint64_t)now.tv_nsec;
+}
+
+void
+mc_drain_trace_reaper()
+{
+  if (reaperEpoll == -1) return;
+
+  // The scheduler may be stopping from within a signal handler, which
+  // might have interrupted it while it held a lock the reaper needs
+  // (e.g. that of `stderr`): do not wait on the reaper forever
+  const uint64_t deadlineNs = mc_monotonic_ns() + 1000000000ul;
+  while (tracesLeftToReap > 0) {
+    const uint64_t nowNs = mc_monotonic_ns();
+    if (nowNs >= deadlineNs) break;
+    const long timeoutMs = (long)((deadlineNs - nowNs + 999999) / 1000000);
+
+    struct pollfd drained;
+    drained.fd     = reaperDrained;
+    drained.events = POLLIN;
+    if (poll(&drained, 1, (int)timeoutMs) == 1) {
+      uint64_t count;
+      read(reaperDrained, &count, sizeof(count));
+    }
+  }
+}
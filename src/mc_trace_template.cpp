@@ -0,0 +1,353 @@
+#include "mc_trace_template.h"
+#include "mcmini_private.h"
+#include "signals.h"
+
+extern "C" {
+#include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+}
+
+/*
+ * The scheduler's end of the connection to the template process, or
+ * -1 if there is no template to ask for traces
+ */
+static int templateChannel = -1;
+
+/*
+ * Sent by the template in reply to a request: either the process id
+ * of the new trace or, if the trace could not be forked, the negated
+ * `errno` of the failure
+ */
+typedef pid_t mc_trace_template_reply;
+
+/*
+ * Each spare trace parks on its own gate, a semaphore shared by the
+ * scheduler, the template and all traces, until the scheduler hands it
+ * the next branch to explore. A spare must not so much as look at
+ * `trace_sleep_list` before then, since the scheduler re-initializes
+ * the list for each new trace. Along with the branch, the spare learns
+ * which generation of the list it is to use.
+ *
+ * A gate handed out is free again once its spare has passed through
+ * it. Several spares may be handed out in quick succession when traces
+ * are replayed ahead of time (see `mc_start_trace_pipeline()`), each
+ * holding on to its gate until it gets to run
+ */
+#define MC_TRACE_GATE_COUNT (SPARE_TRACE_PROCESSES + MAX_LIVE_TRACES)
+
+struct mc_trace_gate {
+  sem_t sem;
+  unsigned sleepListGeneration;
+};
+
+static mc_trace_gate *traceGates = nullptr;
+
+/* The process id of the spare parked on each gate */
+static pid_t sparePids[MC_TRACE_GATE_COUNT];
+
+/*
+ * A first-in first-out queue of gates
+ *
+ * NOTE: The state kept here must not need constructors to run:
+ * `mcmini_main()` is itself a constructor and may run before those of
+ * this file
+ */
+struct mc_trace_gate_queue {
+  int gates[MC_TRACE_GATE_COUNT];
+  int head;
+  int size;
+
+  bool
+  empty() const
+  {
+    return size == 0;
+  }
+
+  bool
+  contains(int gate) const
+  {
+    for (int i = 0; i < size; i++)
+      if (gates[(head + i) % MC_TRACE_GATE_COUNT] == gate) return true;
+    return false;
+  }
+
+  void
+  push(int gate)
+  {
+    gates[(head + size++) % MC_TRACE_GATE_COUNT] = gate;
+  }
+
+  int
+  pop()
+  {
+    const int gate = gates[head];
+    head           = (head + 1) % MC_TRACE_GATE_COUNT;
+    size--;
+    return gate;
+  }
+};
+
+/* Gates of the spares requested from the template, in request order */
+static mc_trace_gate_queue requestedGates;
+
+/* Gates of the spares ready to be handed a trace, in fork order */
+static mc_trace_gate_queue parkedGates;
+
+
+static bool
+mc_read_from_channel(int channel, void *buf, size_t len)
+{
+  char *cur = (char *)buf;
+  while (len > 0) {
+    ssize_t rc = read(channel, cur, len);
+    if (rc == -1 && errno == EINTR) continue;
+    if (rc <= 0) return false;
+    cur += rc;
+    len -= (size_t)rc;
+  }
+  return true;
+}
+
+/*
+ * Runs in each process forked by the template for the scheduler and
+ * turns it into a trace once the scheduler has adopted it and then
+ * opened its gate
+ */
+static void
+mc_start_spare_trace(int channel, pid_t intermediatePid, int gate)
+{
+  close(channel);
+
+  // The intermediate process exits as soon as it has forked us, at
+  // which point the kernel re-parents us to the scheduler (the
+  // nearest child subreaper)
+  while (getppid() == intermediatePid) sched_yield();
+  if (getppid() != scheduler_pid) _exit(EXIT_FAILURE);
+
+  mc_prepare_trace_process();
+  while (__real_sem_wait(&traceGates[gate].sem) == -1 && errno == EINTR)
+    ;
+  trace_sleep_list_generation = traceGates[gate].sleepListGeneration;
+  mc_start_trace_process();
+}
+
+static void
+mc_run_trace_template(int channel)
+{
+  install_sighandles_for_trace_template();
+  prctl(PR_SET_PDEATHSIG, SIGKILL, 0, 0, 0);
+  if (getppid() != scheduler_pid) _exit(EXIT_FAILURE);
+
+  // The intermediate process forking each trace passes the id of the
+  // trace to the template through this pipe
+  int forked[2];
+  if (pipe2(forked, O_CLOEXEC) == -1) _exit(EXIT_FAILURE);
+
+  // Each request names the gate the new spare parks on
+  char gate;
+  while (mc_read_from_channel(channel, &gate, sizeof(gate))) {
+    // The intermediate process exits as soon as it has forked the trace.
+    // The template replies to the scheduler only once it has reaped it,
+    // by which time the trace has been adopted by the scheduler
+    mc_trace_template_reply reply;
+    pid_t intermediatePid = fork();
+    if (FORK_IS_CHILD_PID(intermediatePid)) {
+      const pid_t self = getpid();
+      pid_t tracePid   = fork();
+      if (FORK_IS_CHILD_PID(tracePid)) {
+        close(forked[0]);
+        close(forked[1]);
+        mc_start_spare_trace(channel, self, gate);
+      }
+      reply = tracePid < 0 ? -errno : tracePid;
+      if (write(forked[1], &reply, sizeof(reply)) != sizeof(reply))
+        _exit(EXIT_FAILURE);
+      _exit(EXIT_SUCCESS);
+    } else if (intermediatePid < 0) {
+      reply = -errno;
+    } else {
+      int status;
+      while (waitpid(intermediatePid, &status, 0) == -1 && errno == EINTR)
+        ;
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) break;
+      if (!mc_read_from_channel(forked[0], &reply, sizeof(reply))) break;
+    }
+    if (write(channel, &reply, sizeof(reply)) != sizeof(reply)) break;
+  }
+  _exit(EXIT_SUCCESS);
+}
+
+static void
+mc_close_template_channel()
+{
+  // Should the template ever disappear, fall back to forking traces
+  // directly from the scheduler once the spares run out
+  close(templateChannel);
+  templateChannel = -1;
+  requestedGates.size = 0;
+}
+
+/*
+ * Asks the template to fork a spare that will park on the given gate.
+ * The template works on the request while the scheduler goes on with
+ * its own business; the reply is collected only once the spare is
+ * needed
+ */
+static void
+mc_request_spare_trace(int gate)
+{
+  if (gate == -1) return;
+
+  const char request = (char)gate;
+  ssize_t rc;
+  do {
+    // MSG_NOSIGNAL: a template that has died must not take the
+    // scheduler down with a SIGPIPE
+    rc = send(templateChannel, &request, sizeof(request), MSG_NOSIGNAL);
+  } while (rc == -1 && errno == EINTR);
+
+  if (rc == sizeof(request)) {
+    requestedGates.push(gate);
+  } else {
+    mc_close_template_channel();
+  }
+}
+
+/*
+ * Waits for the template to answer the oldest outstanding request
+ */
+static void
+mc_collect_spare_trace()
+{
+  mc_trace_template_reply reply;
+  if (!mc_read_from_channel(templateChannel, &reply, sizeof(reply))) {
+    mc_close_template_channel();
+    return;
+  }
+  if (reply < 0) {
+    errno = -reply;
+    perror("fork");
+    abort();
+  }
+  const int gate  = requestedGates.pop();
+  sparePids[gate] = reply;
+  parkedGates.push(gate);
+}
+
+/*
+ * Whether the spare last handed the given gate has exited, whether or
+ * not the reaper has collected it yet
+ */
+static bool
+mc_spare_trace_has_exited(int gate)
+{
+  siginfo_t info;
+  info.si_pid = 0;
+  if (waitid(P_PID, sparePids[gate], &info, WEXITED | WNOHANG | WNOWAIT) == -1)
+    return errno == ECHILD;
+  return info.si_pid != 0;
+}
+
+static int
+mc_find_free_trace_gate()
+{
+  for (int gate = 0; gate < MC_TRACE_GATE_COUNT; gate++) {
+    if (requestedGates.contains(gate) || parkedGates.contains(gate))
+      continue;
+
+    int value;
+    sem_getvalue(&traceGates[gate].sem, &value);
+    if (value == 0) return gate;
+
+    // The spare handed this gate was terminated before it got to pass
+    if (mc_spare_trace_has_exited(gate)) {
+      __real_sem_init(&traceGates[gate].sem, SEM_FLAG_SHARED, 0);
+      return gate;
+    }
+  }
+  return -1;
+}
+
+void
+mc_spawn_trace_template()
+{
+  if (getenv(ENV_NO_TRACE_TEMPLATE) != NULL) return;
+
+  void *gates = mmap(nullptr, MC_TRACE_GATE_COUNT * sizeof(mc_trace_gate),
+                     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                     -1, 0);
+  if (gates == MAP_FAILED) {
+    perror("mmap");
+    mc_exit(EXIT_FAILURE);
+  }
+  traceGates = (mc_trace_gate *)gates;
+  for (int gate = 0; gate < MC_TRACE_GATE_COUNT; gate++)
+    __real_sem_init(&traceGates[gate].sem, SEM_FLAG_SHARED, 0);
+
+  int channel[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, channel) == -1) {
+    perror("socketpair");
+    mc_exit(EXIT_FAILURE);
+  }
+
+  // Traces forked by the template are orphaned by their parent and
+  // must be adopted by the scheduler
+  if (prctl(PR_SET_CHILD_SUBREAPER, 1, 0, 0, 0) == -1) {
+    perror("prctl");
+    mc_exit(EXIT_FAILURE);
+  }
+
+  // Anything left in the stdio buffers would otherwise be written out
+  // again by every trace
+  fflush(NULL);
+
+  pid_t templatePid = fork();
+  if (templatePid < 0) {
+    perror("fork");
+    mc_exit(EXIT_FAILURE);
+  }
+  if (FORK_IS_CHILD_PID(templatePid)) {
+    close(channel[0]);
+    mc_run_trace_template(channel[1]);
+  }
+  close(channel[1]);
+  templateChannel = channel[0];
+
+  // The first spares are forked while the scheduler prepares to model
+  // check the program
+  for (int gate = 0; gate < SPARE_TRACE_PROCESSES; gate++)
+    mc_request_spare_trace(gate);
+}
+
+pid_t
+mc_fork_trace_from_template(unsigned generation)
+{
+  if (traceGates == nullptr) return -1;
+
+  if (parkedGates.empty() && templateChannel != -1) {
+    if (requestedGates.empty())
+      mc_request_spare_trace(mc_find_free_trace_gate());
+    if (templateChannel != -1 && !requestedGates.empty())
+      mc_collect_spare_trace();
+  }
+  if (parkedGates.empty()) return -1;
+
+  const int gate = parkedGates.pop();
+  traceGates[gate].sleepListGeneration = generation;
+  __real_sem_post(&traceGates[gate].sem);
+
+  // Replace the spare just handed out before the scheduler next needs one
+  if (templateChannel != -1)
+    mc_request_spare_trace(mc_find_free_trace_gate());
+
+  return sparePids[gate];
+}
@@ -0,0 +1,141 @@
+#include "mc_trace_watchdog.h"
+#include "MCEnv.h"
+
+extern "C" {
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+}
+
+/* How often the CPU time of a trace is checked against its budgets */
+#define MC_TRACE_CPU_POLL_INTERVAL_NS (10ul * 1000 * 1000)
+
+/* The budgets of each trace, in nanoseconds, or 0 if there is none */
+static uint64_t stepWallBudget  = 0;
+static uint64_t traceWallBudget = 0;
+static uint64_t stepCpuBudget   = 0;
+static uint64_t traceCpuBudget  = 0;
+
+/* The CPU-time clock of the current trace and whether it is known */
+static clockid_t traceCpuClock;
+static bool traceCpuClockValid = false;
+
+/* When the current trace was handed its first step */
+static uint64_t traceStartWall = 0;
+static uint64_t traceStartCpu  = 0;
+
+static const char *exceededBudget = "";
+
+static uint64_t
+mc_budget_from_env(const char *name)
+{
+  const char *value = getenv(name);
+  if (value == NULL) return 0;
+  return strtoul(value, nullptr, 10) * 1000 * 1000;
+}
+
+static uint64_t
+mc_monotonic_time()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ul + (uint64_t)now.tv_nsec;
+}
+
+static bool
+mc_read_trace_cpu_time(uint64_t *ns)
+{
+  struct timespec now;
+  if (!traceCpuClockValid || clock_gettime(traceCpuClock, &now) == -1)
+    return false;
+  *ns = (uint64_t)now.tv_sec * 1000000000ul + (uint64_t)now.tv_nsec;
+  return true;
+}
+
+bool
+mc_has_trace_budgets()
+{
+  return stepWallBudget != 0 || traceWallBudget != 0 || stepCpuBudget != 0 ||
+         traceCpuBudget != 0;
+}
+
+void
+mc_load_trace_budgets()
+{
+  stepWallBudget  = mc_budget_from_env(ENV_STEP_TIMEOUT);
+  traceWallBudget = mc_budget_from_env(ENV_TRACE_TIMEOUT);
+  stepCpuBudget   = mc_budget_from_env(ENV_STEP_CPU_LIMIT);
+  traceCpuBudget  = mc_budget_from_env(ENV_TRACE_CPU_LIMIT);
+}
+
+void
+mc_start_trace_budget(pid_t pid)
+{
+  if (!mc_has_trace_budgets()) return;
+
+  traceCpuClockValid = clock_getcpuclockid(pid, &traceCpuClock) == 0;
+  traceStartWall     = mc_monotonic_time();
+  if (!mc_read_trace_cpu_time(&traceStartCpu)) traceStartCpu = 0;
+}
+
+bool
+mc_wait_for_thread_within_budget(mc_shared_sem_ref sem)
+{
+  if (!mc_has_trace_budgets()) {
+    mc_shared_sem_wait_for_thread(sem);
+    return true;
+  }
+
+  const uint64_t stepStartWall = mc_monotonic_time();
+  uint64_t stepStartCpu = 0;
+  const bool watchCpu = (stepCpuBudget != 0 || traceCpuBudget != 0) &&
+                        mc_read_trace_cpu_time(&stepStartCpu);
+
+  for (;;) {
+    uint64_t deadline = UINT64_MAX;
+    if (stepWallBudget != 0 && stepStartWall + stepWallBudget < deadline)
+      deadline = stepStartWall + stepWallBudget;
+    if (traceWallBudget != 0 && traceStartWall + traceWallBudget < deadline)
+      deadline = traceStartWall + traceWallBudget;
+    if (watchCpu) {
+      // CPU time can only be sampled: look at it every so often
+      const uint64_t poll =
+        mc_monotonic_time() + MC_TRACE_CPU_POLL_INTERVAL_NS;
+      if (poll < deadline) deadline = poll;
+    }
+    if (deadline == UINT64_MAX) {
+      mc_shared_sem_wait_for_thread(sem);
+      return true;
+    }
+
+    struct timespec until;
+    until.tv_sec  = deadline / 1000000000ul;
+    until.tv_nsec = deadline % 1000000000ul;
+    if (mc_shared_sem_wait_for_thread_until(sem, &until) == 0) return true;
+
+    const uint64_t wall = mc_monotonic_time();
+    uint64_t cpu;
+    const bool cpuKnown = watchCpu && mc_read_trace_cpu_time(&cpu);
+    if (stepWallBudget != 0 && wall - stepStartWall >= stepWallBudget) {
+      exceededBudget = "wall-clock time per step";
+    } else if (traceWallBudget != 0 &&
+               wall - traceStartWall >= traceWallBudget) {
+      exceededBudget = "wall-clock time per trace";
+    } else if (cpuKnown && stepCpuBudget != 0 &&
+               cpu - stepStartCpu >= stepCpuBudget) {
+      exceededBudget = "CPU time per step";
+    } else if (cpuKnown && traceCpuBudget != 0 &&
+               cpu - traceStartCpu >= traceCpuBudget) {
+      exceededBudget = "CPU time per trace";
+    } else {
+      continue;
+    }
+    return false;
+  }
+}
+
+const char *
+mc_exceeded_trace_budget()
+{
+  return exceededBudget;
+}
@@ -1,8 +1,20 @@
 #include "mcmini_private.h"
 #include "MCSharedTransition.h"
 #include "MCTransitionFactory.h"
+#include "mc_bug_signatures.h"
+#include "mc_exploration_tree.h"
+#include "mc_result_stream.h"
+#include "mc_schedule_replay.h"
+#include "mc_scheduler_profile.h"
+#include "mc_trace_output.h"
+#include "mc_trace_pipeline.h"
+#include "mc_trace_reaper.h"
+#include "mc_trace_template.h"
+#include "mc_trace_watchdog.h"
 #include "signals.h"
 #include "transitions/MCTransitionsShared.h"
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include <sys/wait.h> // For waitpid
 #include <errno.h>    // For errno
@@ -40,8 +52,48 @@ volatile bool mc_reset = false;
  * The process id of the scheduler
  */
 pid_t scheduler_pid = -1;
-mc_shared_sem (*trace_sleep_list)[MAX_TOTAL_THREADS_IN_PROGRAM] =
-  nullptr;
+mc_shared_sem *trace_sleep_list  = nullptr;
+size_t trace_sleep_list_capacity = 0;
+unsigned trace_sleep_list_generation = 0;
+
+/*
+ * For each generation of the sleep list, a pidfd of the last trace to
+ * use it if that trace was left to exit in the background, or -1
+ */
+static int traceSleepListUsers[TRACE_SLEEP_LIST_GENERATIONS];
+
+/* Whether each generation of the sleep list is held by a trace replayed
+ * ahead of time (see `mc_claim_trace_sleep_list_generation()`) */
+static bool traceSleepListHeld[TRACE_SLEEP_LIST_GENERATIONS];
+
+/*
+ * The slot of the sleep list the scheduler waits on for the trace to
+ * hand control back, if it is waiting
+ */
+static std::atomic<mc_shared_sem_ref> slotAwaitedByScheduler{nullptr};
+
+/* Whether the current trace has exited without being asked to */
+static std::atomic<bool> traceStoppedEarly{false};
+
+/* The number of traces cut short for exceeding a time budget */
+static uint64_t tracesOverBudget = 0;
+
+/*
+ * For each step of the transition stack, a checksum of all steps up to
+ * and including it as they were first run: for each, the thread run and
+ * the visible operation it reached (its type and the first word of its
+ * payload, for most operations the address of the object acted on).
+ * Replaying a step must give the same checksum or the trace has diverged
+ */
+static std::vector<uint64_t> stepChecksums;
+
+/* The objects reached by the steps of the current trace so far
+ * NOTE: Allocated with the first trace: `mcmini_main()` is itself a
+ * constructor and may run before the constructors of this file */
+static mc_reached_objects *traceReachedObjects = nullptr;
+
+/* The number of traces whose replay diverged from the original run */
+static uint64_t tracesDiverged = 0;
 sem_t mc_pthread_create_binary_sem;
 
 static char resultString[1000] = "***** Model checking completed! *****\n";
@@ -68,7 +120,18 @@ static void printResults() {
   mcprintf(resultString);
   mcprintf("Number of traces: %lu\n", traceId);
   mcprintf("Total number of transitions: %lu\n", transitionId);
+  mc_print_distinct_bugs();
+  if (tracesOverBudget > 0) {
+    mcprintf("Number of traces over budget (livelock/timeout): %lu\n",
+             tracesOverBudget);
+  }
+  if (tracesDiverged > 0) {
+    mcprintf("Number of traces diverging on replay: %lu\n", tracesDiverged);
+  }
   mcprintf("Elapsed time: %lu seconds\n", time(NULL) - mcmini_start_time);
+  mc_print_scheduler_profile();
+  mc_stream_summary(tracesOverBudget, tracesDiverged);
+  mc_close_exploration_tree();
   if ((int)traceId < programState->traceIdForPrintBacktrace() &&
       getenv(ENV_FIRST_DEADLOCK) == NULL) { // and no --first-deadlock
     mcprintf("*** NOTE: --trace (-t) requested up to trace %d,\n"
@@ -101,9 +164,19 @@ static void printResults() {
 void *shmStart                            = nullptr;
 MCSharedTransition *shmTransitionTypeInfo = nullptr;
 void *shmTransitionData                   = nullptr;
+static const size_t shmMailboxSize =
+  (sizeof(*shmTransitionTypeInfo) + MAX_SHARED_MEMORY_ALLOCATION +
+   SHARED_MEMORY_PAGE_SIZE - 1) &
+  ~(SHARED_MEMORY_PAGE_SIZE - 1);
 const size_t shmAllocationSize =
-  sizeof(*trace_sleep_list) +
-  (sizeof(*shmTransitionTypeInfo) + MAX_SHARED_MEMORY_ALLOCATION);
+  TRACE_SLEEP_LIST_GENERATIONS * shmMailboxSize;
+
+/*
+ * The shared memory file stays open for the lifetime of the scheduler
+ * (and is inherited by each trace) so that the sleep list can be
+ * extended after the region is first mapped
+ */
+static int shmFd = -1;
 
 /* Program state */
 MCDeferred<MCStack> programState;
@@ -125,7 +198,12 @@ ucontext_t mcmini_scheduler_main_context;
 MC_CONSTRUCTOR void
 mcmini_main()
 {
+  // The wrappers of the clocks call on the real clocks (e.g. `time()`
+  // just below) through these addresses
+  mc_load_intercepted_symbol_addresses();
   mcmini_start_time = time(NULL);
+  mc_start_scheduler_profile();
+  mc_open_result_stream();
 
   getcontext(&mcmini_scheduler_main_context);
 
@@ -141,10 +219,14 @@ mcmini_main()
     alarm(3600); // one hour
     signal(SIGALRM, alarm_handler);
   }
-  mc_load_intercepted_symbol_addresses();
   mc_create_global_state_object();
   mc_initialize_shared_memory_globals();
   mc_initialize_trace_sleep_list();
+  mc_load_trace_budgets();
+  mc_start_virtual_clock();
+  mc_create_input_log();
+  mc_create_trace_outputs();
+  mc_open_exploration_tree();
   install_sighandles_for_scheduler();
 
   // Mark this process as the scheduler
@@ -152,6 +234,18 @@ mcmini_main()
   MC_FATAL_ON_FAIL(
     __real_sem_init(&mc_pthread_create_binary_sem, 0, 0) == 0);
 
+  // Traces are forked from a copy of the scheduler made before it has
+  // accumulated any state
+  mc_spawn_trace_template();
+  if (mc_start_trace_reaper()) {
+    mc_start_trace_pipeline();
+  } else {
+    install_sigchld_handler_for_scheduler();
+  }
+
+  if (mc_schedule_to_replay_given()) {
+    mc_replay_schedule(); // Does not return
+  }
   mc_do_model_checking();
 
   printResults();
@@ -163,93 +257,86 @@ mc_create_global_state_object()
 {
   auto config = get_config_for_execution_environment();
   programState.Construct(config);
-  programState->registerVisibleOperationType(typeid(MCThreadStart),
-                                             &MCReadThreadStart);
-  programState->registerVisibleOperationType(typeid(MCThreadCreate),
-                                             &MCReadThreadCreate);
-  programState->registerVisibleOperationType(typeid(MCThreadFinish),
-                                             &MCReadThreadFinish);
-  programState->registerVisibleOperationType(typeid(MCThreadJoin),
-                                             &MCReadThreadJoin);
-  programState->registerVisibleOperationType(typeid(MCMutexInit),
-                                             &MCReadMutexInit);
-  programState->registerVisibleOperationType(typeid(MCMutexUnlock),
-                                             &MCReadMutexUnlock);
-  programState->registerVisibleOperationType(typeid(MCMutexLock),
-                                             &MCReadMutexLock);
-  programState->registerVisibleOperationType(typeid(MCSemInit),
-                                             &MCReadSemInit);
-  programState->registerVisibleOperationType(typeid(MCSemPost),
-                                             &MCReadSemPost);
-  programState->registerVisibleOperationType(typeid(MCSemWait),
-                                             &MCReadSemWait);
-  programState->registerVisibleOperationType(typeid(MCSemEnqueue),
-                                             &MCReadSemEnqueue);
-  programState->registerVisibleOperationType(typeid(MCExitTransition),
-                                             &MCReadExitTransition);
-  programState->registerVisibleOperationType(
-    typeid(MCAbortTransition), &MCReadAbortTransition);
-  programState->registerVisibleOperationType(typeid(MCBarrierEnqueue),
-                                             &MCReadBarrierEnqueue);
-  programState->registerVisibleOperationType(typeid(MCBarrierInit),
-                                             &MCReadBarrierInit);
-  programState->registerVisibleOperationType(typeid(MCBarrierWait),
-                                             &MCReadBarrierWait);
-  programState->registerVisibleOperationType(typeid(MCCondInit),
-                                             &MCReadCondInit);
-  programState->registerVisibleOperationType(typeid(MCCondSignal),
-                                             &MCReadCondSignal);
-  programState->registerVisibleOperationType(typeid(MCCondBroadcast),
-                                             &MCReadCondBroadcast);
-  programState->registerVisibleOperationType(typeid(MCCondWait),
-                                             &MCReadCondWait);
-  programState->registerVisibleOperationType(typeid(MCCondEnqueue),
-                                             &MCReadCondEnqueue);
-  programState->registerVisibleOperationType(typeid(MCRWLockInit),
-                                             &MCReadRWLockInit);
-  programState->registerVisibleOperationType(
-    typeid(MCRWLockReaderEnqueue), &MCReadRWLockReaderEnqueue);
-  programState->registerVisibleOperationType(
-    typeid(MCRWLockWriterEnqueue), &MCReadRWLockWriterEnqueue);
-  programState->registerVisibleOperationType(
-    typeid(MCRWLockWriterLock), &MCReadRWLockWriterLock);
-  programState->registerVisibleOperationType(
-    typeid(MCRWLockReaderLock), &MCReadRWLockReaderLock);
-  programState->registerVisibleOperationType(typeid(MCRWLockUnlock),
-                                             &MCReadRWLockUnlock);
-
-  programState->registerVisibleOperationType(typeid(MCRWWLockInit),
-                                             &MCReadRWWLockInit);
-  programState->registerVisibleOperationType(
-    typeid(MCRWWLockReaderEnqueue), &MCReadRWWLockReaderEnqueue);
-  programState->registerVisibleOperationType(
-    typeid(MCRWWLockReaderLock), &MCReadRWWLockReaderLock);
-  programState->registerVisibleOperationType(
-    typeid(MCRWWLockWriter1Enqueue), &MCReadRWWLockWriter1Enqueue);
-  programState->registerVisibleOperationType(
-    typeid(MCRWWLockWriter1Lock), &MCReadRWWLockWriter1Lock);
-  programState->registerVisibleOperationType(
-    typeid(MCRWWLockWriter2Enqueue), &MCReadRWWLockWriter2Enqueue);
-  programState->registerVisibleOperationType(
-    typeid(MCRWWLockWriter2Lock), &MCReadRWWLockWriter2Lock);
-  programState->registerVisibleOperationType(typeid(MCRWWLockUnlock),
-                                             &MCReadRWWLockUnlock);
-  programState->registerVisibleOperationType(
-    typeid(MCGlobalVariableRead), &MCReadGlobalRead);
-  programState->registerVisibleOperationType(
-    typeid(MCGlobalVariableWrite), &MCReadGlobalWrite);
+  programState->registerVisibleOperationType<MCThreadStart>(
+    &MCReadThreadStart);
+  programState->registerVisibleOperationType<MCThreadCreate>(
+    &MCReadThreadCreate);
+  programState->registerVisibleOperationType<MCThreadFinish>(
+    &MCReadThreadFinish);
+  programState->registerVisibleOperationType<MCThreadJoin>(
+    &MCReadThreadJoin);
+  programState->registerVisibleOperationType<MCMutexInit>(
+    &MCReadMutexInit);
+  programState->registerVisibleOperationType<MCMutexUnlock>(
+    &MCReadMutexUnlock);
+  programState->registerVisibleOperationType<MCMutexLock>(
+    &MCReadMutexLock);
+  programState->registerVisibleOperationType<MCSemInit>(
+    &MCReadSemInit);
+  programState->registerVisibleOperationType<MCSemPost>(
+    &MCReadSemPost);
+  programState->registerVisibleOperationType<MCSemWait>(
+    &MCReadSemWait);
+  programState->registerVisibleOperationType<MCSemEnqueue>(
+    &MCReadSemEnqueue);
+  programState->registerVisibleOperationType<MCExitTransition>(
+    &MCReadExitTransition);
+  programState->registerVisibleOperationType<MCAbortTransition>(
+    &MCReadAbortTransition);
+  programState->registerVisibleOperationType<MCBarrierEnqueue>(
+    &MCReadBarrierEnqueue);
+  programState->registerVisibleOperationType<MCBarrierInit>(
+    &MCReadBarrierInit);
+  programState->registerVisibleOperationType<MCBarrierWait>(
+    &MCReadBarrierWait);
+  programState->registerVisibleOperationType<MCCondInit>(
+    &MCReadCondInit);
+  programState->registerVisibleOperationType<MCCondSignal>(
+    &MCReadCondSignal);
+  programState->registerVisibleOperationType<MCCondBroadcast>(
+    &MCReadCondBroadcast);
+  programState->registerVisibleOperationType<MCCondWait>(
+    &MCReadCondWait);
+  programState->registerVisibleOperationType<MCCondEnqueue>(
+    &MCReadCondEnqueue);
+  programState->registerVisibleOperationType<MCRWLockInit>(
+    &MCReadRWLockInit);
+  programState->registerVisibleOperationType<MCRWLockReaderEnqueue>(
+    &MCReadRWLockReaderEnqueue);
+  programState->registerVisibleOperationType<MCRWLockWriterEnqueue>(
+    &MCReadRWLockWriterEnqueue);
+  programState->registerVisibleOperationType<MCRWLockWriterLock>(
+    &MCReadRWLockWriterLock);
+  programState->registerVisibleOperationType<MCRWLockReaderLock>(
+    &MCReadRWLockReaderLock);
+  programState->registerVisibleOperationType<MCRWLockUnlock>(
+    &MCReadRWLockUnlock);
+
+  programState->registerVisibleOperationType<MCRWWLockInit>(
+    &MCReadRWWLockInit);
+  programState->registerVisibleOperationType<MCRWWLockReaderEnqueue>(
+    &MCReadRWWLockReaderEnqueue);
+  programState->registerVisibleOperationType<MCRWWLockReaderLock>(
+    &MCReadRWWLockReaderLock);
+  programState->registerVisibleOperationType<MCRWWLockWriter1Enqueue>(
+    &MCReadRWWLockWriter1Enqueue);
+  programState->registerVisibleOperationType<MCRWWLockWriter1Lock>(
+    &MCReadRWWLockWriter1Lock);
+  programState->registerVisibleOperationType<MCRWWLockWriter2Enqueue>(
+    &MCReadRWWLockWriter2Enqueue);
+  programState->registerVisibleOperationType<MCRWWLockWriter2Lock>(
+    &MCReadRWWLockWriter2Lock);
+  programState->registerVisibleOperationType<MCRWWLockUnlock>(
+    &MCReadRWWLockUnlock);
+  programState->registerVisibleOperationType<MCGlobalVariableRead>(
+    &MCReadGlobalRead);
+  programState->registerVisibleOperationType<MCGlobalVariableWrite>(
+    &MCReadGlobalWrite);
   programState->start();
 }
 
 int countVisibleObjectsOfType(int objectId) {
-  int count = 0;
-  for (int i = 0; i <= objectId; i++) {
-    if (typeid(*(programState->getObjectWithId(i))) ==
-        typeid(*(programState->getObjectWithId(objectId)))) {
-      count++;
-    }
-  }
-  return count;
+  return programState->getOrdinalOfObjectWithId(objectId);
 }
 
 void
@@ -268,23 +355,38 @@ mc_explore_branch(int curBranchPoint)
 {
   tid_t backtrackThread;
 
+  mc_stream_trace_start();
   if (curBranchPoint == FIRST_BRANCH) {
-    mc_fork_new_trace();
     backtrackThread = TID_MAIN_THREAD;
+    mc_exploration_tree_begin_trace(0, backtrackThread);
+    mc_fork_new_trace();
   } else { // else next branch
     auto *sNext = &(programState->getStateItemAtIndex(curBranchPoint));
     backtrackThread = sNext->popThreadToBacktrackOn();
+    mc_exploration_tree_begin_trace(curBranchPoint, backtrackThread);
 
     // Prepare the scheduler's model of the next trace
     programState->reflectStateAtTransitionIndex(curBranchPoint - 1);
 
-    mc_fork_next_trace_at_current_state();
+    const uint64_t adoptionBegin = mc_begin_phase();
+    const bool replayed = mc_adopt_prepared_trace(curBranchPoint);
+    if (replayed) mc_end_phase(MC_PHASE_REPLAY, adoptionBegin);
+    mc_prepare_traces_ahead(curBranchPoint);
+    if (!replayed && !mc_fork_next_trace_at_current_state())
+      backtrackThread = TID_INVALID; // The replay was cut short
   }
 
-  mc_search_dpor_branch_with_thread(backtrackThread);
+  if (backtrackThread != TID_INVALID)
+    mc_search_dpor_branch_with_thread(backtrackThread);
+  mc_exploration_tree_end_trace();
   // If '-t <traceId>' set and current traceId matches it, then exit.
   mc_exit_with_trace_if_necessary(traceId);
 
+  // The branch points the search has left are explored deepest first:
+  // the next few can be replayed while the next is explored
+  const int nextBranchPoint = programState->getDeepestDPORBranchPoint();
+  mc_prepare_traces_ahead(nextBranchPoint);
+
   traceId++;
   if (false && traceId >= 1 && getenv(ENV_PRINT_AT_TRACE_SEQ) != NULL) {
     mcprintf("*** Trace sequence ('-t', --trace') requested.\n"
@@ -303,9 +405,10 @@ mc_explore_branch(int curBranchPoint)
     if (time(NULL) - last_time_reported > 10) {
       last_time_reported = time(NULL);
       mcprintf("... %d traces analyzed so far ...\n", traceId);
+      mc_stream_progress();
     }
   }
-  return programState->getDeepestDPORBranchPoint();
+  return nextBranchPoint;
 }
 
 void
@@ -347,7 +450,8 @@ mc_allocate_shared_memory_region()
     }
     mc_exit(EXIT_FAILURE);
   }
-  int rc = ftruncate(fd, shmAllocationSize);
+  const size_t initialSize = shmAllocationSize + SHARED_MEMORY_PAGE_SIZE;
+  int rc = ftruncate(fd, initialSize);
   if (rc == -1) {
     perror("ftruncate");
     mc_exit(EXIT_FAILURE);
@@ -356,18 +460,26 @@ mc_allocate_shared_memory_region()
   // pointer
   //   to an address in the stack data structure will not work
   //   everywhere. Hopefully, this address is not already used.
+  //
+  // The whole address range the region may ever grow into is reserved
+  // up front so that the sleep list can be extended in place
   void *stack_address = (void *)0x4444000;
-  void *shmStart =
-    mmap(stack_address, shmAllocationSize, PROT_READ | PROT_WRITE,
-         MAP_SHARED | MAP_FIXED, fd, 0);
+  void *reserved =
+    mmap(stack_address, MAX_SHARED_MEMORY_RESERVATION, PROT_NONE,
+         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+  if (reserved == MAP_FAILED) {
+    perror("mmap");
+    mc_exit(EXIT_FAILURE);
+  }
+  void *shmStart = mmap(stack_address, initialSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_FIXED, fd, 0);
   if (shmStart == MAP_FAILED) {
     perror("mmap");
     mc_exit(EXIT_FAILURE);
   }
   // shm_unlink(dpor); // Don't unlink while child processes need to
   // open this.
-  fsync(fd);
-  close(fd);
+  shmFd = fd;
   return shmStart;
 }
 
@@ -376,11 +488,13 @@ mc_deallocate_shared_memory_region()
 {
   char shm_file_name[100];
   mc_get_shm_handle_name(shm_file_name, sizeof(shm_file_name));
-  int rc = munmap(shmStart, shmAllocationSize);
+  int rc = munmap(shmStart, MAX_SHARED_MEMORY_RESERVATION);
   if (rc == -1) {
     perror("munmap");
     mc_exit(EXIT_FAILURE);
   }
+  close(shmFd);
+  shmFd = -1;
 
   rc = shm_unlink(shm_file_name);
   if (rc == -1) {
@@ -399,34 +513,174 @@ void
 mc_initialize_shared_memory_globals()
 {
   void *shm              = mc_allocate_shared_memory_region();
-  void *threadQueueStart = shm;
-  void *shmTransitionTypeInfoStart =
-    (char *)threadQueueStart + sizeof(*trace_sleep_list);
-  void *shmTransitionDataStart = (char *)shmTransitionTypeInfoStart +
-                                 sizeof(*shmTransitionTypeInfo);
+  void *threadQueueStart = (char *)shm + shmAllocationSize;
 
   shmStart = shm;
+  mc_select_trace_mailbox(trace_sleep_list_generation);
   trace_sleep_list =
     static_cast<typeof(trace_sleep_list)>(threadQueueStart);
-  shmTransitionTypeInfo = static_cast<typeof(shmTransitionTypeInfo)>(
-    shmTransitionTypeInfoStart);
-  shmTransitionData = shmTransitionDataStart;
+  trace_sleep_list_capacity =
+    SHARED_MEMORY_PAGE_SIZE / sizeof(*trace_sleep_list);
+}
+
+static MCSharedTransition *
+mc_trace_mailbox_type_info(unsigned generation)
+{
+  return static_cast<MCSharedTransition *>(
+    (void *)((char *)shmStart + generation * shmMailboxSize));
+}
+
+static void *
+mc_trace_mailbox_data(unsigned generation)
+{
+  return mc_trace_mailbox_type_info(generation) + 1;
+}
+
+void
+mc_select_trace_mailbox(unsigned generation)
+{
+  shmTransitionTypeInfo = mc_trace_mailbox_type_info(generation);
+  shmTransitionData     = mc_trace_mailbox_data(generation);
 }
 
 void
 mc_initialize_trace_sleep_list()
 {
-  for (unsigned int i = 0; i < MAX_TOTAL_THREADS_IN_PROGRAM; i++)
-    mc_shared_sem_init(&(*trace_sleep_list)[i]);
+  for (int i = 0; i < TRACE_SLEEP_LIST_GENERATIONS; i++)
+    traceSleepListUsers[i] = -1;
+  for (size_t i = 0; i < trace_sleep_list_capacity; i++)
+    mc_shared_sem_init(&trace_sleep_list[i]);
+}
+
+/*
+ * Maps the pages of the shared memory file backing slots
+ * `[trace_sleep_list_capacity, count)` of the sleep list (rounded up to
+ * a whole page) into this process and returns the new capacity
+ */
+static size_t
+mc_map_trace_sleep_list_pages(size_t count)
+{
+  const size_t slotsPerPage =
+    SHARED_MEMORY_PAGE_SIZE / sizeof(*trace_sleep_list);
+  // The last slot mapped may end short of the end of its page
+  const size_t mappedBytes =
+    (trace_sleep_list_capacity * sizeof(*trace_sleep_list) +
+     SHARED_MEMORY_PAGE_SIZE - 1) &
+    ~(SHARED_MEMORY_PAGE_SIZE - 1);
+  const size_t neededBytes =
+    ((count + slotsPerPage - 1) / slotsPerPage) * SHARED_MEMORY_PAGE_SIZE;
+
+  if (shmAllocationSize + neededBytes > MAX_SHARED_MEMORY_RESERVATION) {
+    mcprintf("*** McMini cannot track more than %lu threads ***\n",
+             (unsigned long)((MAX_SHARED_MEMORY_RESERVATION -
+                              shmAllocationSize) /
+                             sizeof(*trace_sleep_list) /
+                             TRACE_SLEEP_LIST_GENERATIONS));
+    mc_stop_model_checking(EXIT_FAILURE);
+  }
+
+  void *extension = mmap((char *)trace_sleep_list + mappedBytes,
+                         neededBytes - mappedBytes, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_FIXED, shmFd,
+                         shmAllocationSize + mappedBytes);
+  if (extension == MAP_FAILED) {
+    perror("mmap");
+    mc_stop_model_checking(EXIT_FAILURE);
+  }
+  return neededBytes / sizeof(*trace_sleep_list);
 }
 
 void
-mc_reset_cv_locks()
+mc_grow_trace_sleep_list(size_t count)
 {
-  for (unsigned int i = 0; i < MAX_TOTAL_THREADS_IN_PROGRAM; i++) {
-    mc_shared_sem_destroy(&(*trace_sleep_list)[i]);
-    mc_shared_sem_init(&(*trace_sleep_list)[i]);
+  count *= TRACE_SLEEP_LIST_GENERATIONS;
+  if (count <= trace_sleep_list_capacity) return;
+
+  // Double to keep the number of resizes logarithmic in the number of
+  // threads
+  size_t newCapacity = 2 * trace_sleep_list_capacity;
+  if (newCapacity < count) newCapacity = count;
+
+  const size_t oldCapacity = trace_sleep_list_capacity;
+  const size_t slotsPerPage =
+    SHARED_MEMORY_PAGE_SIZE / sizeof(*trace_sleep_list);
+  const size_t fileSize =
+    shmAllocationSize + ((newCapacity + slotsPerPage - 1) / slotsPerPage) *
+                          SHARED_MEMORY_PAGE_SIZE;
+  if (ftruncate(shmFd, fileSize) == -1) {
+    perror("ftruncate");
+    mc_stop_model_checking(EXIT_FAILURE);
   }
+  trace_sleep_list_capacity = mc_map_trace_sleep_list_pages(newCapacity);
+
+  for (size_t i = oldCapacity; i < trace_sleep_list_capacity; i++)
+    mc_shared_sem_init(&trace_sleep_list[i]);
+}
+
+void
+mc_map_trace_sleep_list(size_t count)
+{
+  count *= TRACE_SLEEP_LIST_GENERATIONS;
+  if (count <= trace_sleep_list_capacity) return;
+  trace_sleep_list_capacity = mc_map_trace_sleep_list_pages(count);
+}
+
+/*
+ * Picks the generation of the sleep list to come after the given one
+ * that is neither held by a trace replayed ahead of time nor the one
+ * skipped, and readies it for a new trace
+ */
+static unsigned
+mc_ready_trace_sleep_list_generation(unsigned previous, unsigned skipped)
+{
+  unsigned generation = previous;
+  do {
+    generation = (generation + 1) % TRACE_SLEEP_LIST_GENERATIONS;
+  } while (traceSleepListHeld[generation] || generation == skipped);
+
+  // The last trace to use this generation must be gone before its
+  // semaphores are re-initialized. It has had at least the whole of
+  // the previous trace to exit, so it rarely keeps the scheduler waiting
+  int &lastUser = traceSleepListUsers[generation];
+  if (lastUser != -1) {
+    mc_await_trace_exit(lastUser);
+    lastUser = -1;
+  }
+  mc_reset_trace_output(generation);
+
+  for (size_t i = generation; i < trace_sleep_list_capacity;
+       i += TRACE_SLEEP_LIST_GENERATIONS) {
+    mc_shared_sem_destroy(&trace_sleep_list[i]);
+    mc_shared_sem_init(&trace_sleep_list[i]);
+  }
+  return generation;
+}
+
+void
+mc_reset_cv_locks()
+{
+  trace_sleep_list_generation = mc_ready_trace_sleep_list_generation(
+    trace_sleep_list_generation, TRACE_SLEEP_LIST_GENERATIONS);
+  mc_select_trace_mailbox(trace_sleep_list_generation);
+  mc_set_input_log_writer(trace_sleep_list_generation);
+}
+
+unsigned
+mc_claim_trace_sleep_list_generation()
+{
+  static unsigned lastClaimed = 0;
+  lastClaimed = mc_ready_trace_sleep_list_generation(
+    lastClaimed, trace_sleep_list_generation);
+  traceSleepListHeld[lastClaimed] = true;
+  return lastClaimed;
+}
+
+void
+mc_release_trace_sleep_list_generation(unsigned generation, int lastUser)
+{
+  MC_ASSERT(traceSleepListHeld[generation]);
+  traceSleepListHeld[generation]  = false;
+  traceSleepListUsers[generation] = lastUser;
 }
 
 void
@@ -436,124 +690,427 @@ mc_fork_new_trace()
   // exist to prevent fork bombing
   MC_ASSERT(trace_pid == -1);
 
-  pid_t childpid;
-  if ((childpid = fork()) < 0) {
-    perror("fork");
-    abort();
-  }
-  trace_pid = childpid;
+  trace_pid = mc_fork_trace_process(trace_sleep_list_generation);
+  if (traceReachedObjects == nullptr)
+    traceReachedObjects = new mc_reached_objects();
+  traceReachedObjects->ordinals.clear();
+  traceStoppedEarly = false;
+  mc_supervise_trace(trace_pid, traceId);
+  mc_start_trace_budget(trace_pid);
+}
 
-  if (FORK_IS_CHILD_PID(childpid)) {
-    prctl(PR_SET_PDEATHSIG, SIGUSR1, 0, 0); // In McMini, SIGUSR1 to kill child
-    if (getenv(ENV_QUIET) != NULL) {
-      close(0); assert(open("/dev/null", O_RDONLY) == 0);
-      close(1); assert(open("/dev/null", O_WRONLY) == 1);
-      close(2); assert(open("/dev/null", O_WRONLY) == 2);
+pid_t
+mc_fork_trace_process(unsigned generation)
+{
+  const uint64_t forkBegin = mc_begin_phase();
+  pid_t childpid = mc_fork_trace_from_template(generation);
+  if (childpid == -1) {
+    if ((childpid = fork()) < 0) {
+      perror("fork");
+      abort();
     }
+    if (FORK_IS_CHILD_PID(childpid)) {
+      trace_sleep_list_generation = generation;
+      mc_prepare_trace_process();
+      mc_start_trace_process();
+    }
+  }
+  mc_end_phase(MC_PHASE_FORK, forkBegin);
+  return childpid;
+}
 
-    install_sighandles_for_trace();
+void
+mc_adopt_trace(pid_t pid, unsigned generation, mc_reached_objects &objects)
+{
+  MC_ASSERT(trace_pid == -1);
+  MC_ASSERT(traceSleepListHeld[generation]);
+
+  traceSleepListHeld[generation] = false;
+  trace_sleep_list_generation    = generation;
+  mc_select_trace_mailbox(generation);
+  mc_set_input_log_writer(generation);
+
+  trace_pid = pid;
+  traceReachedObjects->ordinals.swap(objects.ordinals);
+  traceStoppedEarly = false;
+  mc_supervise_trace(trace_pid, traceId);
+  mc_start_trace_budget(trace_pid);
+}
+
+void
+mc_prepare_trace_process()
+{
+  prctl(PR_SET_PDEATHSIG, SIGUSR1, 0, 0); // In McMini, SIGUSR1 to kill child
+  // The scheduler may have exited before the call to prctl()
+  if (getppid() != scheduler_pid) _exit(EXIT_FAILURE);
+
+  if (getenv(ENV_QUIET) != NULL) {
+    close(0); assert(open("/dev/null", O_RDONLY) == 0);
+    close(1); assert(open("/dev/null", O_WRONLY) == 1);
+    close(2); assert(open("/dev/null", O_WRONLY) == 2);
+  }
+
+  install_sighandles_for_trace();
+  mc_virtualize_trace_time();
+  mc_start_trace_input_log();
+
+  // We need to reset the concurrent system
+  // for the child since, at the time this method
+  // is invoked, it will have a complete copy of
+  // the state the of system. But we need to
+  // re-simulate the system by running the transitions
+  // in the transition stack; otherwise, shadow resource
+  // allocations will be off
+  programState->reset();
+  programState->start();
+  mc_register_main_thread();
+
+  // NOTE: Technically, the child will be frozen
+  // inside of dpor_init until it is scheduled. But
+  // this is only a technicality: it doesn't actually
+  // matter where the child spawns so long as it reaches
+  // the actual source program
+  tid_self = 0;
+
+  // Note that the child process does
+  // not need to re-map the shared memory
+  // region as the parent has already done that
+
+  // This is important to handle the case when the
+  // main thread hits return 0; in that case, we
+  // keep the process alive to allow the model checker to
+  // continue working
+  //
+  // NOTE!!: atexit handlers can be invoked when a dynamic
+  // library is unloaded. In the transparent target, we need
+  // to be able to handle this case gracefully
+  MC_FATAL_ON_FAIL(atexit(&mc_exit_main_thread) == 0);
+}
+
+void
+mc_start_trace_process()
+{
+  mc_select_trace_mailbox(trace_sleep_list_generation);
+  mc_capture_trace_output();
+  thread_await_scheduler_for_thread_start_transition();
 
-    // We need to reset the concurrent system
-    // for the child since, at the time this method
-    // is invoked, it will have a complete copy of
-    // the state the of system. But we need to
-    // re-simulate the system by running the transitions
-    // in the transition stack; otherwise, shadow resource
-    // allocations will be off
-    programState->reset();
-    programState->start();
-    mc_register_main_thread();
+  setcontext(&mcmini_scheduler_main_context);
+}
 
-    // NOTE: Technically, the child will be frozen
-    // inside of dpor_init until it is scheduled. But
-    // this is only a technicality: it doesn't actually
-    // matter where the child spawns so long as it reaches
-    // the actual source program
-    tid_self = 0;
+/*
+ * Whether the thread running the given transition touches state of its
+ * trace which other threads of the trace touch without synchronizing
+ * (the ids the trace gives new threads), or ends the trace: such a step
+ * is replayed on its own
+ */
+static bool
+mc_replays_alone(const MCTransition &transition)
+{
+  return dynamic_cast<const MCThreadCreate *>(&transition) != nullptr ||
+         dynamic_cast<const MCExitTransition *>(&transition) != nullptr ||
+         dynamic_cast<const MCAbortTransition *>(&transition) != nullptr;
+}
+
+/*
+ * Replays the transition stack in the current trace, letting each step
+ * run as soon as the steps it depends on have (see
+ * `mc_fork_next_trace_at_current_state()`)
+ */
+static bool
+mc_replay_transition_stack_concurrently()
+{
+  const int tStackHeight = programState->getTransitionStackSize();
 
-    // Note that the child process does
-    // not need to re-map the shared memory
-    // region as the parent has already done that
+  // The steps each step waits for: the previous step of its own thread
+  // and the steps of other threads which happen before it
+  std::vector<std::vector<int>> predecessors(tStackHeight);
+  std::vector<bool> alone(tStackHeight);
+  std::vector<int> lastStepOfThread(programState->getNumProgramThreads(), -1);
+  for (int i = 0; i < tStackHeight; i++) {
+    const tid_t tid = programState->getThreadRunningTransitionAtIndex(i);
+    predecessors[i] =
+      programState->getCausalPredecessorsOfTransitionAtIndex(i);
+    if (lastStepOfThread[tid] != -1)
+      predecessors[i].push_back(lastStepOfThread[tid]);
+    lastStepOfThread[tid] = i;
+    alone[i] = mc_replays_alone(programState->getTransitionAtIndex(i));
+  }
 
-    // This is important to handle the case when the
-    // main thread hits return 0; in that case, we
-    // keep the process alive to allow the model checker to
-    // continue working
-    //
-    // NOTE!!: atexit handlers can be invoked when a dynamic
-    // library is unloaded. In the transparent target, we need
-    // to be able to handle this case gracefully
-    MC_FATAL_ON_FAIL(atexit(&mc_exit_main_thread) == 0);
+  // The scheduler collects the steps in the order of the stack, which
+  // keeps the checksums comparable; the steps behind the first step not
+  // yet collected have all completed
+  std::vector<bool> released(tStackHeight, false);
+  uint64_t checksum = 0;
+  for (int first = 0; first < tStackHeight; first++) {
+    const int end =
+      std::min(tStackHeight, first + MC_CONCURRENT_REPLAY_WINDOW);
+    for (int i = first; i < end; i++) {
+      if (!released[i]) {
+        bool ready = !alone[i] || i == first;
+        for (int predecessor : predecessors[i])
+          if (predecessor >= first) ready = false;
+        if (ready) {
+          mc_wake_thread_for_next_visible_operation(
+            programState->getThreadRunningTransitionAtIndex(i));
+          released[i] = true;
+        }
+      }
+      // Nothing runs alongside a step replayed on its own
+      if (alone[i]) break;
+    }
 
-    thread_await_scheduler_for_thread_start_transition();
+    const tid_t tid = programState->getThreadRunningTransitionAtIndex(first);
+    if (!mc_await_thread_at_next_visible_operation(tid)) return false;
 
-    setcontext(&mcmini_scheduler_main_context);
+    checksum = mc_checksum_step(checksum, tid, mc_trace_sleep_list_slot(tid),
+                                *traceReachedObjects);
+    if (checksum != stepChecksums[first]) {
+      mc_report_replay_divergence(first, tid);
+      return false;
+    }
   }
+  return true;
 }
 
-void
-mc_fork_next_trace_at_current_state()
+/*
+ * Replays the transition stack in the current trace (see
+ * `mc_fork_next_trace_at_current_state()`)
+ */
+static bool
+mc_replay_transition_stack()
 {
-  mc_reset_cv_locks();
-  mc_fork_new_trace();
+  static const bool concurrentReplay =
+    getenv(ENV_CONCURRENT_REPLAY) != NULL;
+  if (concurrentReplay) return mc_replay_transition_stack_concurrently();
 
   const int tStackHeight = programState->getTransitionStackSize();
 
+  uint64_t checksum = 0;
   for (int i = 0; i < tStackHeight; i++) {
     // NOTE: This is reliant on the fact
     // that threads are created in the same order
     // when we create them. This will always be consistent,
     // but we might need to look out for when a thread dies
     tid_t nextTid = programState->getThreadRunningTransitionAtIndex(i);
-    mc_run_thread_to_next_visible_operation(nextTid);
+    if (!mc_run_thread_to_next_visible_operation(nextTid)) return false;
+
+    checksum = mc_checksum_step(checksum, nextTid,
+                                mc_trace_sleep_list_slot(nextTid),
+                                *traceReachedObjects);
+    if (checksum != stepChecksums[i]) {
+      mc_report_replay_divergence(i, nextTid);
+      return false;
+    }
   }
+  return true;
+}
+
+bool
+mc_fork_next_trace_at_current_state()
+{
+  mc_reset_cv_locks();
+  mc_fork_new_trace();
+
+  const uint64_t replayBegin = mc_begin_phase();
+  const bool replayed        = mc_replay_transition_stack();
+  mc_end_phase(MC_PHASE_REPLAY, replayBegin);
+  return replayed;
+}
+
+uint64_t
+mc_reached_objects::ordinalOf(uint64_t object)
+{
+  if (object == 0) return 0;
+  return ordinals.emplace(object, ordinals.size() + 1).first->second;
+}
+
+uint64_t
+mc_checksum_step(uint64_t checksum, tid_t tid, mc_shared_sem_ref slot,
+                 mc_reached_objects &objects)
+{
+  const uint64_t step[] = {tid, slot->reached_type,
+                           objects.ordinalOf(slot->reached_object)};
+  for (uint64_t word : step) {
+    checksum ^= word + 0x9e3779b97f4a7c15ul + (checksum << 6) +
+                (checksum >> 2);
+  }
+  return checksum;
+}
+
+void
+mc_record_step_checksum(int step, tid_t tid)
+{
+  if (stepChecksums.size() <= (size_t)step)
+    stepChecksums.resize(2 * (size_t)step + 1);
+  const uint64_t previous = step > 0 ? stepChecksums[step - 1] : 0;
+  stepChecksums[step]     = mc_checksum_step(
+    previous, tid, mc_trace_sleep_list_slot(tid), *traceReachedObjects);
+}
+
+uint64_t
+mc_step_checksum(int step)
+{
+  return stepChecksums[step];
+}
+
+void
+mc_report_replay_divergence(int step, tid_t tid)
+{
+  mcprintf("TraceId %lu, *** REPLAY DIVERGED ***\n"
+           "  (thread %lu did not reach the same visible operation at step"
+           " %d as when the step was first run; the target behaves"
+           " differently from one run to the next)\n",
+           traceId, tid, step + 1);
+  programState->printTransitionStack();
+  tracesDiverged++;
+  mc_stream_trace_outcome("diverged");
+  mc_terminate_trace();
 }
 
-void mc_run_thread_to_next_visible_operation(tid_t tid) {
+bool mc_run_thread_to_next_visible_operation(tid_t tid) {
+  mc_wake_thread_for_next_visible_operation(tid);
+  return mc_await_thread_at_next_visible_operation(tid);
+}
+
+void
+mc_wake_thread_for_next_visible_operation(tid_t tid)
+{
   MC_ASSERT(tid != TID_INVALID);
-  mc_shared_sem_ref sem = &(*trace_sleep_list)[tid];
+  // The transition may create a thread: make sure it will find its
+  // slot in the sleep list initialized
+  mc_grow_trace_sleep_list(programState->getNumProgramThreads() + 1);
+
   // Slightly dangerous: We're depending on sem FIFO policy.
   // We post to sem.  Then tid wakes up and runs while we wait on sem.
   // Then tid reaches next visible operation, posts to us, and waits.
   // But suppose we post to tid, we wait, and wakeup goes to us, not to tid.
   // A more careful version would use two semaphores: "tid wait" and "we wait".
-  mc_shared_sem_wake_thread(sem);
-  mc_shared_sem_wait_for_thread(sem);
+  mc_shared_sem_wake_thread(mc_trace_sleep_list_slot(tid));
+}
+
+bool
+mc_await_thread_at_next_visible_operation(tid_t tid)
+{
+  mc_shared_sem_ref sem = mc_trace_sleep_list_slot(tid);
+
+  // Should the trace exit while we wait, whoever notices wakes us on
+  // `sem` (see `mc_notify_trace_stopped_early()`)
+  slotAwaitedByScheduler = sem;
+  if (traceStoppedEarly) mc_report_trace_stopped_early();
+
+  const bool withinBudget = mc_wait_for_thread_within_budget(sem);
+
+  slotAwaitedByScheduler = nullptr;
+  if (traceStoppedEarly) mc_report_trace_stopped_early();
+  mc_trim_trace_output();
+  if (!withinBudget) mc_report_trace_over_budget(tid);
+  return withinBudget;
+}
+
+void
+mc_report_trace_over_budget(tid_t tid)
+{
+  bool newBug;
+  const unsigned bugId = mc_classify_bug("livelock", tid, &newBug);
+  if (newBug) {
+    mcprintf("TraceId %lu, *** LIVELOCK/TIMEOUT DETECTED ***\n"
+             "  (thread %lu exceeded the budget of %s)\n",
+             traceId, tid, mc_exceeded_trace_budget());
+    programState->printTransitionStack();
+    programState->printNextTransitions();
+    mc_print_trace_output();
+  }
+  addResult("*** LIVELOCK/TIMEOUT DETECTED ***\n");
+  tracesOverBudget++;
+  mc_stream_bug("livelock", tid, bugId, newBug);
+  mc_stream_trace_outcome("livelock");
+
+  // The trace may well still be spinning: it is killed just the same
+  mc_terminate_trace();
+}
+
+void
+mc_notify_trace_stopped_early()
+{
+  traceStoppedEarly = true;
+  mc_shared_sem_ref sem = slotAwaitedByScheduler;
+  if (sem != nullptr) mc_shared_sem_wake_scheduler(sem);
+}
+
+void
+mc_report_trace_stopped_early()
+{
+  // The trace is gone: there is nothing left to terminate
+  trace_pid = -1;
+
+  fprintf(stderr,
+          "traceId %lu stopped early!\n"
+          "  (possible SEGFAULT, assert failure, or exit with failure\n"
+          "   between thread operations)\n",
+          traceId);
+
+  // Write the trace contents out
+  programState->printTransitionStack();
+  programState->printNextTransitions();
+  mc_print_trace_output();
+  bool newBug;
+  const unsigned bugId = mc_classify_bug("crash", TID_INVALID, &newBug);
+  mc_stream_bug("crash", TID_INVALID, bugId, newBug);
+  mc_stream_trace_outcome("crash");
+  mc_stream_summary(tracesOverBudget, tracesDiverged);
+  mc_close_exploration_tree();
+  mc_stop_model_checking(EXIT_FAILURE);
 }
 
 void mc_terminate_trace() {
   if (mc_reset) return;  // User decided to do 'mcmini back'
   if (trace_pid == -1) return;  // No child
+  const uint64_t teardownBegin = mc_begin_phase();
+  // The trace tears itself down while the scheduler moves on. It is
+  // handed to the reaper first so that its exit is known to be expected
+  int pidfd = mc_reap_trace_in_background(trace_pid, traceId);
   kill(trace_pid, SIGUSR1);
-  mc_wait_for_trace();
+  if (pidfd != -1) {
+    traceSleepListUsers[trace_sleep_list_generation] = pidfd;
+  } else {
+    mc_wait_for_trace();
+  }
   trace_pid = -1;
+  mc_end_phase(MC_PHASE_TEARDOWN, teardownBegin);
 }
 
 void mc_wait_for_trace() {
   MC_ASSERT(trace_pid != -1);
 
   int status;
-  char *v = getenv(ENV_VERBOSE);
-  bool verbose = v ? v[0] == '1' : false;
   if (waitpid(trace_pid, &status, 0) == -1) {
-    if (verbose) {
+    char *v = getenv(ENV_VERBOSE);
+    if (v ? v[0] == '1' : false) {
       fprintf(stderr, "Error waiting for trace process with pid `%lu` %s\n",
               (uint64_t)trace_pid, strerror(errno));
     }
-  } else if (verbose) {
-    // Check how the trace process exited
-    if (WIFEXITED(status)) {
-      fprintf(stderr,
-              "Trace process with traceId `%lu` exited with status %d\n",
-              traceId, WEXITSTATUS(status));
-    } else if (WIFSIGNALED(status)) {
-      fprintf(stderr,
-              "Trace process with traceId `%lu` was killed by signal `%d`\n",
-              traceId, WTERMSIG(status));
-    } else {
-      fprintf(stderr, "Trace process with traceId `%lu` exited abnormally.\n",
-              traceId);
-    }
+  } else {
+    mc_report_trace_exit(traceId, status);
+  }
+}
+
+void mc_report_trace_exit(trid_t id, int status) {
+  char *v = getenv(ENV_VERBOSE);
+  bool verbose = v ? v[0] == '1' : false;
+  if (!verbose) return;
+
+  // Check how the trace process exited
+  if (WIFEXITED(status)) {
+    fprintf(stderr,
+            "Trace process with traceId `%lu` exited with status %d\n",
+            id, WEXITSTATUS(status));
+  } else if (WIFSIGNALED(status)) {
+    fprintf(stderr,
+            "Trace process with traceId `%lu` was killed by signal `%d`\n",
+            id, WTERMSIG(status));
+  } else {
+    fprintf(stderr, "Trace process with traceId `%lu` exited abnormally.\n",
+            id);
   }
 }
 
@@ -587,22 +1144,25 @@ mc_search_dpor_branch_with_thread(const tid_t backtrackThread)
   const MCTransition &initialTransition =
     programState->getNextTransitionForThread(backtrackThread);
   const MCTransition *nextTransition = &initialTransition;
+  const uint64_t maxTotalTransitions =
+    programState->getConfiguration().maxTotalTransitions;
 
   // TODO: Assert whether or not nextTransition is enabled
   // TODO: Assert whether a trace process exists at this point
 
   do {
-    if (depth >= MAX_TOTAL_TRANSITIONS_IN_PROGRAM) {
+    if ((uint64_t)depth >= maxTotalTransitions) {
+      mc_stream_trace_outcome("limit");
       printResults();
       mcprintf(
         "*** Execution Limit Reached! ***\n\n"
         "McMini ran a trace with %lu transitions.  To increase this limit,\n"
-        "modify MAX_TOTAL_TRANSITIONS_IN_PROGRAM in MCConstants.h and"
-        " re-compile.\n"
+        "run mcmini with the \"--max-transitions\" flag (\"-M\");"
+        " \"-M0\" removes it.\n"
         "But first, try running mcmini with the \"--max-depth-per-thread\""
         " flag (\"-m\")\n"
         "to limit how far into a trace a McMini thread can go.\n",
-        depth);
+        (unsigned long)depth);
       mc_stop_model_checking(EXIT_FAILURE);
     }
 
@@ -611,32 +1171,61 @@ mc_search_dpor_branch_with_thread(const tid_t backtrackThread)
 
     const tid_t tid = nextTransition->getThreadId();
     // Execute in target application
-    mc_run_thread_to_next_visible_operation(tid);
+    uint64_t phaseBegin = mc_begin_phase();
+    if (!mc_run_thread_to_next_visible_operation(tid)) {
+      // The trace was cut short: move on to the next branch
+      return;
+    }
+    mc_end_phase(MC_PHASE_STEP, phaseBegin);
+
+    mc_record_step_checksum(depth - 1, tid);
 
     // Execute model ("simulate" transition means to update model w/ transition)
+    phaseBegin = mc_begin_phase();
     programState->simulateRunningTransition(
       *nextTransition, shmTransitionTypeInfo, shmTransitionData);
+    mc_end_phase(MC_PHASE_SIMULATE, phaseBegin);
     // Record the transition in the "history", for later backtracking
+    phaseBegin = mc_begin_phase();
     programState->dynamicallyUpdateBacktrackSets();
+    mc_end_phase(MC_PHASE_BACKTRACK, phaseBegin);
 
     /* Check for data races */
+    phaseBegin = mc_begin_phase();
     {
       const MCTransition &nextTransitionForTid =
         programState->getNextTransitionForThread(tid);
       if (programState->hasADataRaceWithNewTransition(
             nextTransitionForTid)) {
-        mcprintf("*** DATA RACE DETECTED ***\n");
-        programState->printTransitionStack();
-        programState->printNextTransitions();
+        bool newBug;
+        const unsigned bugId = mc_classify_bug("data_race", tid, &newBug);
+        // Later traces running into the same race are only counted
+        if (newBug) {
+          mcprintf("*** DATA RACE DETECTED ***\n");
+          programState->printTransitionStack();
+          programState->printNextTransitions();
+          mc_print_trace_output();
+        }
         addResult("*** DATA RACE DETECTED ***\n");
+        mc_stream_bug("data_race", tid, bugId, newBug);
       }
     }
 
     nextTransition = programState->getFirstEnabledTransition();
-
-    if (nextTransition == nullptr ||
-        (traceSeqLength() > 0 && programState->isInDeadlock())) {
-      const bool hasDeadlock = programState->isInDeadlock();
+    const bool traceEnds =
+      nextTransition == nullptr ||
+      (traceSeqLength() > 0 && programState->isInDeadlock());
+    const bool hasDeadlock = traceEnds && programState->isInDeadlock();
+    mc_end_phase(MC_PHASE_CHECKS, phaseBegin);
+
+    if (traceEnds) {
+      bool newBug = false;
+      if (hasDeadlock) {
+        const unsigned bugId =
+          mc_classify_bug("deadlock", TID_INVALID, &newBug);
+        mc_stream_bug("deadlock", TID_INVALID, bugId, newBug);
+      }
+      mc_stream_trace_outcome(hasDeadlock ? "deadlock" : "ok");
       if (hasDeadlock && nextTransition != nullptr) { // Stop using traceSeq
         addResult("  [Truncating traceSeq from '-t', due to deadlock!]\n");
         nextTransition = nullptr;
@@ -646,9 +1235,13 @@ mc_search_dpor_branch_with_thread(const tid_t backtrackThread)
       int verbose = v ? v[0] - '0' : 0;
 
       if (hasDeadlock) {
-        mcprintf("TraceId %lu, *** DEADLOCK DETECTED ***\n", traceId);
-        programState->printTransitionStack();
-        programState->printNextTransitions();
+        // Later traces running into the same deadlock are only counted
+        if (newBug) {
+          mcprintf("TraceId %lu, *** DEADLOCK DETECTED ***\n", traceId);
+          programState->printTransitionStack();
+          programState->printNextTransitions();
+          mc_print_trace_output();
+        }
         addResult("*** DEADLOCK DETECTED ***\n");
         if (verbose) {
           mcprintf("TraceId %ld:  ", traceId);
@@ -750,6 +1343,19 @@ mc_exit_with_trace_if_necessary(trid_t trid)
   }
 }
 
+std::string
+mc_describe_transition(const MCTransition &transition)
+{
+  char description[512];
+  mcprintf_capture(description, sizeof(description));
+  transition.print();
+  mcprintf_stop_capture();
+
+  size_t len = strlen(description);
+  while (len > 0 && description[len - 1] == '\n') len--;
+  return std::string(description, len);
+}
+
 MCStackConfiguration
 get_config_for_execution_environment()
 {
@@ -759,6 +1365,7 @@ get_config_for_execution_environment()
   // single process that forks, exec()s w/LD_PRELOAD set, and then
   // remotely controls THAT process. We need to discuss this
   uint64_t maxThreadDepth = MC_STATE_CONFIG_THREAD_NO_LIMIT;
+  uint64_t maxTotalTransitions = DEFAULT_MAX_TOTAL_TRANSITIONS_IN_PROGRAM;
   trid_t printBacktraceAtTraceNumber = MC_STATE_CONFIG_PRINT_AT_TRACE;
   bool firstDeadlock                  = false;
   bool expectForwardProgressOfThreads = false;
@@ -768,6 +1375,13 @@ get_config_for_execution_environment()
     maxThreadDepth = strtoul(getenv(ENV_MAX_DEPTH_PER_THREAD), nullptr, 10);
   }
 
+  if (getenv(ENV_MAX_TRANSITIONS) != NULL) {
+    maxTotalTransitions = strtoul(getenv(ENV_MAX_TRANSITIONS), nullptr, 10);
+    if (maxTotalTransitions == 0) {
+      maxTotalTransitions = MC_STATE_CONFIG_TRANSITIONS_NO_LIMIT;
+    }
+  }
+
   if (getenv(ENV_PRINT_AT_TRACE_ID) != NULL) {
     printBacktraceAtTraceNumber =
       strtoul(getenv(ENV_PRINT_AT_TRACE_ID), nullptr, 10);
@@ -780,8 +1394,8 @@ get_config_for_execution_environment()
     firstDeadlock = true;
   }
 
-  return {maxThreadDepth, printBacktraceAtTraceNumber, firstDeadlock,
-          expectForwardProgressOfThreads};
+  return {maxThreadDepth, maxTotalTransitions, printBacktraceAtTraceNumber,
+          firstDeadlock, expectForwardProgressOfThreads};
 }
 
 bool
@@ -801,10 +1415,30 @@ mc_exit(int status)
   _Exit(status);
 }
 
+/*
+ * Kills the trace the scheduler is running as the scheduler stops.
+ * Unlike `mc_terminate_trace()`, this may run in a signal handler (see
+ * `sigint_handler_scheduler()`) and so sticks to async-signal-safe calls
+ */
+static void
+mc_kill_trace_on_stop()
+{
+  if (mc_reset) return;  // User decided to do 'mcmini back'
+  if (trace_pid == -1) return;  // No child
+  const bool reaped = mc_expect_supervised_trace_exit();
+  kill(trace_pid, SIGUSR1);
+  if (!reaped) {
+    while (waitpid(trace_pid, nullptr, 0) == -1 && errno == EINTR)
+      ;
+  }
+  trace_pid = -1;
+}
+
 void
 mc_stop_model_checking(int status)
 {
   mc_deallocate_shared_memory_region();
-  mc_terminate_trace();
+  mc_kill_trace_on_stop();
+  mc_drain_trace_reaper();
   mc_exit(status);
 }
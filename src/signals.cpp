@@ -37,6 +37,16 @@ install_sighandles_for_trace()
   return rc;
 }
 
+int
+install_sighandles_for_trace_template()
+{
+  int rc = 0;
+  rc |= sigremovehandler(SIGUSR1);
+  rc |= sigremovehandler(SIGCHLD);
+  rc |= sigsethandler(SIGINT, SIG_IGN);
+  return rc;
+}
+
 void
 sigusr1_handler_trace(int sig)
 {
@@ -49,14 +59,17 @@ install_sighandles_for_scheduler()
 {
   int rc = sigsethandler(SIGUSR1, &sigusr1_handler_scheduler);
   rc |= sigsethandler(SIGINT, &sigint_handler_scheduler);
+  return rc;
+}
 
+int
+install_sigchld_handler_for_scheduler()
+{
   struct sigaction action;
   action.sa_flags     = SA_SIGINFO;
   action.sa_sigaction = &sigchld_handler_scheduler;
   sigemptyset(&action.sa_mask);
-  rc |= sigaction(SIGCHLD, &action, NULL);
-
-  return rc;
+  return sigaction(SIGCHLD, &action, NULL);
 }
 
 void
@@ -80,7 +93,9 @@ sigchld_handler_scheduler(int sig, siginfo_t *info, void *unused)
 {
   // This is the normal case: a child exited normally (i.e. was sent a
   // SIGUSR1 and was *explicitly* killed by the scheduler since we
-  // intercept calls to exit(2)) so this is not an error
+  // intercept calls to exit(2)) so this is not an error. Its exit
+  // status is reported once the scheduler waits for it (see
+  // `mc_wait_for_trace()`)
   if (info->si_code == CLD_EXITED) { return; }
 
   // Another normal case: SIGINT should not be a cause for alarm
@@ -89,23 +104,7 @@ sigchld_handler_scheduler(int sig, siginfo_t *info, void *unused)
     return;
   }
 
-  // FIXME: Most of the function calls made below are not async-signal
-  // safe. We need to fix this in the future to improve McMini's
-  // robustness/correctness
-  char msg[512];
-  int len =
-    snprintf(msg, sizeof(msg),
-             "traceId %lu stopped early!\n"
-             "  (possible SEGFAULT, assert failure, or exit with failure\n"
-             "   between thread operations)\n",
-             traceId);
-  msg[len] = '\0';
-
-  assert(write(STDERR_FILENO, msg, len) == len);
-  fsync(STDERR_FILENO);
-
-  // Write the trace contents out
-  programState->printTransitionStack();
-  programState->printNextTransitions();
-  mc_stop_model_checking(EXIT_FAILURE);
+  // The failure is reported by the scheduler once it wakes up: nothing
+  // that is not async-signal-safe may run here
+  if (info->si_pid == trace_pid) mc_notify_trace_stopped_early();
 }
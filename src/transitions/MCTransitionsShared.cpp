@@ -7,7 +7,7 @@ void
 thread_await_scheduler()
 {
   MC_ASSERT(tid_self != TID_INVALID);
-  mc_shared_sem_ref cv = &(*trace_sleep_list)[tid_self];
+  mc_shared_sem_ref cv = mc_trace_sleep_list_slot(tid_self);
   mc_shared_sem_wake_scheduler(cv);
   mc_shared_sem_wait_for_scheduler(cv);
 }
@@ -23,7 +23,7 @@ void
 thread_await_scheduler_for_thread_start_transition()
 {
   MC_ASSERT(tid_self != TID_INVALID);
-  mc_shared_sem_ref cv = &(*trace_sleep_list)[tid_self];
+  mc_shared_sem_ref cv = mc_trace_sleep_list_slot(tid_self);
   mc_shared_sem_wait_for_scheduler(cv);
 }
 
@@ -31,16 +31,32 @@ void
 thread_awake_scheduler_for_thread_finish_transition()
 {
   MC_ASSERT(tid_self != TID_INVALID);
-  mc_shared_sem_ref cv = &(*trace_sleep_list)[tid_self];
+  mc_shared_sem_ref cv = mc_trace_sleep_list_slot(tid_self);
   mc_shared_sem_wake_scheduler(cv);
 }
 
 void
-thread_post_visible_operation_hit(const std::type_info &type)
+thread_post_visible_operation_hit(MCTransitionTypeID type)
 {
   auto newTypeInfo = MCSharedTransition(tid_self, type);
   // NOTE:  This cast could be done in a more complicated C++ way:
   //        https://stackoverflow.com/questions/66368061/error-clearing-an-object-of-non-trivial-type-with-memset
   memcpy((void *)shmTransitionTypeInfo, (void *)(&newTypeInfo),
          sizeof(MCSharedTransition));
+  thread_record_visible_operation(type, nullptr, 0);
+}
+
+// Leaves the operation in the thread's own slot, where the scheduler
+// finds it even if other threads have since written to the mailbox
+void
+thread_record_visible_operation(MCTransitionTypeID type, const void *payload,
+                                size_t size)
+{
+  uint64_t object = 0;
+  if (payload != nullptr)
+    memcpy(&object, payload, size < sizeof(object) ? size : sizeof(object));
+
+  mc_shared_sem_ref cv = mc_trace_sleep_list_slot(tid_self);
+  cv->reached_type     = type;
+  cv->reached_object   = object;
 }
@@ -61,6 +61,11 @@ MCBarrierEnqueue::coenabledWith(const MCTransition *other) const
 bool
 MCBarrierEnqueue::dependentWith(const MCTransition *other) const
 {
+  // Threads arriving at the barrier commute: whatever their order, the
+  // same threads are waiting on it afterwards
+  if (dynamic_cast<const MCBarrierEnqueue *>(other) != nullptr) {
+    return false;
+  }
   const MCBarrierTransition *maybeBarrierOperation =
     dynamic_cast<const MCBarrierTransition *>(other);
   if (maybeBarrierOperation) {
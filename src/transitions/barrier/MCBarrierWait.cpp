@@ -13,13 +13,8 @@ MCReadBarrierWait(const MCSharedTransition *shmTransition,
   // TODO: Figure out how to deal with undefined behavior
   MC_ASSERT(barrierThatExists != nullptr);
 
-  auto executor = shmTransition->executor;
-  if (!barrierThatExists->isWaitingOnBarrier(executor)) {
-    barrierThatExists->wait(
-      executor); // Add this thread to the waiting queue ->
-                 // potentially unblocks threads waiting on the
-                 // barrier
-  }
+  // The thread is already waiting on the barrier: it was added to the
+  // waiting queue by the `MCBarrierEnqueue` before this transition
 
   tid_t threadThatRanId = shmTransition->executor;
   auto threadThatRan    = state->getThreadWithId(threadThatRanId);
@@ -53,7 +48,8 @@ MCBarrierWait::dynamicCopyInState(const MCStack *state) const
 void
 MCBarrierWait::applyToState(MCStack *state)
 {
-  // We don't actually need to do anything here
+  // The thread is through: it may wait on the barrier again later
+  barrier->leave(this->getThreadId());
 }
 
 bool
@@ -1,5 +1,6 @@
 #include "transitions/wrappers/MCBarrierWrappers.h"
 #include "transitions/MCTransitionsShared.h"
+#include "transitions/barrier/MCBarrierEnqueue.h"
 #include "transitions/barrier/MCBarrierInit.h"
 #include "transitions/barrier/MCBarrierWait.h"
 
@@ -14,7 +15,7 @@ mc_pthread_barrier_init(pthread_barrier_t *barrier,
 {
   auto newlyCreatedShadow = MCBarrierShadow(barrier, count);
   thread_post_visible_operation_hit<MCBarrierShadow>(
-    typeid(MCBarrierInit), &newlyCreatedShadow);
+    MCTransitionType<MCBarrierInit>::id, &newlyCreatedShadow);
   thread_await_scheduler();
   return __real_pthread_barrier_init(barrier, attr, count);
 }
@@ -28,7 +29,11 @@ mc_pthread_barrier_wait(pthread_barrier_t *barrier)
   // other wrapper functions as well
   auto newlyCreatedShadow = MCBarrierShadow(barrier, 0);
   thread_post_visible_operation_hit<MCBarrierShadow>(
-    typeid(MCBarrierWait), &newlyCreatedShadow);
+    MCTransitionType<MCBarrierEnqueue>::id, &newlyCreatedShadow);
+  thread_await_scheduler();
+
+  thread_post_visible_operation_hit<MCBarrierShadow>(
+    MCTransitionType<MCBarrierWait>::id, &newlyCreatedShadow);
   thread_await_scheduler();
 
   // We don't directly call pthread_barrier_wait here since we'd have
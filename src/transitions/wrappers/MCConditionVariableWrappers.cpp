@@ -14,7 +14,7 @@ int
 mc_pthread_cond_init(pthread_cond_t *cond,
                      const pthread_condattr_t *attr)
 {
-  thread_post_visible_operation_hit(typeid(MCCondInit), &cond);
+  thread_post_visible_operation_hit(MCTransitionType<MCCondInit>::id, &cond);
   thread_await_scheduler();
   return __real_pthread_cond_init(cond, attr);
 }
@@ -25,11 +25,11 @@ mc_pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
 
   const auto condPlusMutex =
     MCSharedMemoryConditionVariable(cond, mutex);
-  thread_post_visible_operation_hit(typeid(MCCondEnqueue),
+  thread_post_visible_operation_hit(MCTransitionType<MCCondEnqueue>::id,
                                     &condPlusMutex);
   thread_await_scheduler();
   __real_pthread_mutex_unlock(mutex);
-  thread_post_visible_operation_hit(typeid(MCCondWait),
+  thread_post_visible_operation_hit(MCTransitionType<MCCondWait>::id,
                                     &condPlusMutex);
   thread_await_scheduler();
   __real_pthread_mutex_lock(mutex);
@@ -39,7 +39,7 @@ mc_pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
 int
 mc_pthread_cond_signal(pthread_cond_t *cond)
 {
-  thread_post_visible_operation_hit(typeid(MCCondSignal), &cond);
+  thread_post_visible_operation_hit(MCTransitionType<MCCondSignal>::id, &cond);
   thread_await_scheduler();
   return 0;
 }
@@ -47,7 +47,7 @@ mc_pthread_cond_signal(pthread_cond_t *cond)
 int
 mc_pthread_cond_broadcast(pthread_cond_t *cond)
 {
-  thread_post_visible_operation_hit(typeid(MCCondBroadcast), &cond);
+  thread_post_visible_operation_hit(MCTransitionType<MCCondBroadcast>::id, &cond);
   thread_await_scheduler();
   return 0;
 }
@@ -11,7 +11,7 @@ void *
 mcmini_read(void *addr)
 {
   thread_post_visible_operation_hit<void *>(
-    typeid(MCGlobalVariableRead), &addr);
+    MCTransitionType<MCGlobalVariableRead>::id, &addr);
   thread_await_scheduler();
   return addr;
 }
@@ -21,7 +21,7 @@ mcmini_write(void *addr, void *newValue)
 {
   auto writeData = MCGlobalVariableWriteData(addr, newValue);
   thread_post_visible_operation_hit<MCGlobalVariableWriteData>(
-    typeid(MCGlobalVariableWrite), &writeData);
+    MCTransitionType<MCGlobalVariableWrite>::id, &writeData);
   thread_await_scheduler();
 
   // FIXME: We don't really support writes in general. We'd
@@ -0,0 +1,302 @@
+#include "transitions/wrappers/MCInputWrappers.h"
+#include "MCEnv.h"
+#include "mcmini_private.h"
+#include <atomic>
+#include <new>
+
+extern "C" {
+#include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+}
+
+enum mc_input_kind : uint32_t {
+  MC_INPUT_GETPID = 1,
+  MC_INPUT_RAND,
+  MC_INPUT_RANDOM,
+  MC_INPUT_GETRANDOM,
+  MC_INPUT_READ,
+};
+
+/*
+ * The answers recorded for the calls of one thread, in the order in
+ * which the thread made them. Each answer takes up a header (the kind
+ * of call and the number of bytes asked for, if any), the value
+ * returned and, for calls filling a buffer, the bytes written to it
+ */
+struct mc_thread_input_log {
+  uint64_t length;
+  uint64_t words[MC_INPUT_LOG_WORDS_PER_THREAD];
+};
+
+/* The log of each thread, shared by all traces; null if unused */
+static mc_thread_input_log *inputLog = nullptr;
+
+/*
+ * The generation of the sleep list of the one trace allowed to write to
+ * the log, in the page of shared memory before it. Traces replaying a
+ * branch ahead of time only replay steps already run, whose answers are
+ * in the log: they read it without ever writing to it
+ */
+static std::atomic<unsigned> *inputLogWriter = nullptr;
+
+/* Whether this process is a trace replaying its inputs */
+static bool inputReplayActive = false;
+
+/* How far into its log each thread of this trace is */
+static uint64_t inputLogCursor[MC_INPUT_LOG_THREADS];
+
+static uint64_t
+mc_input_header(mc_input_kind kind, uint32_t request)
+{
+  return ((uint64_t)kind << 32) | request;
+}
+
+static uint64_t
+mc_input_words(int64_t value, const void *data)
+{
+  const uint64_t bytes = (data != nullptr && value > 0) ? (uint64_t)value : 0;
+  return 2 + (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+}
+
+static mc_thread_input_log *
+mc_input_log_of_current_thread()
+{
+  if (!inputReplayActive || tid_self >= MC_INPUT_LOG_THREADS) return nullptr;
+  return &inputLog[tid_self];
+}
+
+static bool
+mc_is_input_log_writer()
+{
+  return *inputLogWriter == trace_sleep_list_generation;
+}
+
+/*
+ * Looks for the answer to the calling thread's next call in its log,
+ * returning the value (and, if `data` is set, the bytes) recorded for
+ * it if the call is the one made when the answer was recorded
+ */
+static bool
+mc_replay_input(mc_thread_input_log *log, mc_input_kind kind,
+                uint32_t request, int64_t *value, void *data)
+{
+  uint64_t &cursor = inputLogCursor[tid_self];
+  if (cursor >= log->length) return false;
+
+  if (log->words[cursor] == mc_input_header(kind, request)) {
+    *value = (int64_t)log->words[cursor + 1];
+    if (data != nullptr && *value > 0)
+      memcpy(data, &log->words[cursor + 2], (size_t)*value);
+    cursor += mc_input_words(*value, data);
+    return true;
+  }
+
+  // The thread has gone a different way than when the rest of its log
+  // was recorded: answers are recorded anew from here on
+  if (mc_is_input_log_writer()) log->length = cursor;
+  return false;
+}
+
+static void
+mc_record_input(mc_thread_input_log *log, mc_input_kind kind,
+                uint32_t request, int64_t value, const void *data)
+{
+  uint64_t &cursor = inputLogCursor[tid_self];
+  const uint64_t words = mc_input_words(value, data);
+  if (!mc_is_input_log_writer() || cursor != log->length ||
+      cursor + words > MC_INPUT_LOG_WORDS_PER_THREAD)
+    return;
+
+  log->words[cursor]     = mc_input_header(kind, request);
+  log->words[cursor + 1] = (uint64_t)value;
+  if (words > 2) memcpy(&log->words[cursor + 2], data, (size_t)value);
+  cursor += words;
+  log->length = cursor;
+}
+
+/*
+ * Whether each file descriptor below `MC_INPUT_TRACKED_FDS` was opened
+ * on `/dev/random` or `/dev/urandom`, so that telling whether a read is
+ * to be replayed costs no system call
+ */
+static bool randomDeviceFds[MC_INPUT_TRACKED_FDS];
+
+static bool
+mc_is_random_device(int fd)
+{
+  return fd >= 0 && fd < MC_INPUT_TRACKED_FDS && randomDeviceFds[fd];
+}
+
+static void
+mc_set_random_device(int fd, bool isRandomDevice)
+{
+  if (fd >= 0 && fd < MC_INPUT_TRACKED_FDS)
+    randomDeviceFds[fd] = isRandomDevice;
+}
+
+static int
+mc_classify_opened_fd(int fd, const char *path)
+{
+  mc_set_random_device(fd, path != nullptr &&
+                             (strcmp(path, "/dev/random") == 0 ||
+                              strcmp(path, "/dev/urandom") == 0));
+  return fd;
+}
+
+void
+mc_create_input_log()
+{
+  if (getenv(ENV_NO_INPUT_REPLAY) != NULL) return;
+
+  // Only the pages the traces actually write to are ever allocated
+  void *log = mmap(nullptr,
+                   SHARED_MEMORY_PAGE_SIZE +
+                     MC_INPUT_LOG_THREADS * sizeof(mc_thread_input_log),
+                   PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (log == MAP_FAILED) {
+    perror("mmap");
+    mc_exit(EXIT_FAILURE);
+  }
+  inputLogWriter = new (log) std::atomic<unsigned>(trace_sleep_list_generation);
+  inputLog = (mc_thread_input_log *)((char *)log + SHARED_MEMORY_PAGE_SIZE);
+}
+
+void
+mc_set_input_log_writer(unsigned generation)
+{
+  if (inputLogWriter != nullptr) *inputLogWriter = generation;
+}
+
+void
+mc_start_trace_input_log()
+{
+  inputReplayActive = inputLog != nullptr;
+  memset(inputLogCursor, 0, sizeof(inputLogCursor));
+}
+
+pid_t
+mc_getpid()
+{
+  // Each trace is a process of its own and is given its own id, lest
+  // the target act on (e.g. signal) a trace that is gone. The call is
+  // logged nonetheless so that the calls after it line up
+  const pid_t pid          = __real_getpid();
+  mc_thread_input_log *log = mc_input_log_of_current_thread();
+  if (log == nullptr) return pid;
+
+  int64_t value;
+  if (!mc_replay_input(log, MC_INPUT_GETPID, 0, &value, nullptr))
+    mc_record_input(log, MC_INPUT_GETPID, 0, 0, nullptr);
+  return pid;
+}
+
+int
+mc_rand()
+{
+  mc_thread_input_log *log = mc_input_log_of_current_thread();
+  if (log == nullptr) return __real_rand();
+
+  int64_t value;
+  if (mc_replay_input(log, MC_INPUT_RAND, 0, &value, nullptr))
+    return (int)value;
+  const int r = __real_rand();
+  mc_record_input(log, MC_INPUT_RAND, 0, r, nullptr);
+  return r;
+}
+
+long
+mc_random()
+{
+  mc_thread_input_log *log = mc_input_log_of_current_thread();
+  if (log == nullptr) return __real_random();
+
+  int64_t value;
+  if (mc_replay_input(log, MC_INPUT_RANDOM, 0, &value, nullptr))
+    return (long)value;
+  const long r = __real_random();
+  mc_record_input(log, MC_INPUT_RANDOM, 0, r, nullptr);
+  return r;
+}
+
+ssize_t
+mc_getrandom(void *buf, size_t len, unsigned int flags)
+{
+  mc_thread_input_log *log = mc_input_log_of_current_thread();
+  if (log == nullptr || len > UINT32_MAX)
+    return __real_getrandom(buf, len, flags);
+
+  int64_t value;
+  if (mc_replay_input(log, MC_INPUT_GETRANDOM, (uint32_t)len, &value, buf))
+    return (ssize_t)value;
+  const ssize_t rc = __real_getrandom(buf, len, flags);
+  if (rc >= 0) mc_record_input(log, MC_INPUT_GETRANDOM, (uint32_t)len, rc, buf);
+  return rc;
+}
+
+ssize_t
+mc_read(int fd, void *buf, size_t count)
+{
+  mc_thread_input_log *log = mc_input_log_of_current_thread();
+  if (log == nullptr || count > UINT32_MAX || !mc_is_random_device(fd))
+    return __real_read(fd, buf, count);
+
+  int64_t value;
+  if (mc_replay_input(log, MC_INPUT_READ, (uint32_t)count, &value, buf))
+    return (ssize_t)value;
+  const ssize_t rc = __real_read(fd, buf, count);
+  if (rc >= 0) mc_record_input(log, MC_INPUT_READ, (uint32_t)count, rc, buf);
+  return rc;
+}
+
+int
+mc_open(const char *path, int flags, mode_t mode)
+{
+  return mc_classify_opened_fd(__real_open(path, flags, mode), path);
+}
+
+int
+mc_open64(const char *path, int flags, mode_t mode)
+{
+  return mc_classify_opened_fd(__real_open64(path, flags, mode), path);
+}
+
+int
+mc_openat(int dirfd, const char *path, int flags, mode_t mode)
+{
+  return mc_classify_opened_fd(__real_openat(dirfd, path, flags, mode),
+                               path);
+}
+
+int
+mc_openat64(int dirfd, const char *path, int flags, mode_t mode)
+{
+  return mc_classify_opened_fd(
+    __real_openat64(dirfd, path, flags, mode), path);
+}
+
+int
+mc_close(int fd)
+{
+  mc_set_random_device(fd, false);
+  return __real_close(fd);
+}
+
+int
+mc_dup2(int oldfd, int newfd)
+{
+  const int rc = __real_dup2(oldfd, newfd);
+  if (rc >= 0) mc_set_random_device(rc, mc_is_random_device(oldfd));
+  return rc;
+}
+
+int
+mc_dup3(int oldfd, int newfd, int flags)
+{
+  const int rc = __real_dup3(oldfd, newfd, flags);
+  if (rc >= 0) mc_set_random_device(rc, mc_is_random_device(oldfd));
+  return rc;
+}
@@ -15,7 +15,7 @@ mc_pthread_mutex_init(pthread_mutex_t *mutex,
   // The handler doesn't care about the other arguments
   auto newlyCreatedMutex = MCMutexShadow(mutex);
   thread_post_visible_operation_hit<MCMutexShadow>(
-    typeid(MCMutexInit), &newlyCreatedMutex);
+    MCTransitionType<MCMutexInit>::id, &newlyCreatedMutex);
   thread_await_scheduler();
 
   // TODO: What should we do when this fails
@@ -28,7 +28,7 @@ mc_pthread_mutex_lock(pthread_mutex_t *mutex)
   // The join handler doesn't care about the other arguments
   auto newlyCreatedMutex = MCMutexShadow(mutex);
   thread_post_visible_operation_hit<MCMutexShadow>(
-    typeid(MCMutexLock), &newlyCreatedMutex);
+    MCTransitionType<MCMutexLock>::id, &newlyCreatedMutex);
   thread_await_scheduler();
 
   // TODO: What should we do when this fails
@@ -41,7 +41,7 @@ mc_pthread_mutex_unlock(pthread_mutex_t *mutex)
   // The join handler doesn't care about the other arguments
   auto newlyCreatedMutex = MCMutexShadow(mutex);
   thread_post_visible_operation_hit<MCMutexShadow>(
-    typeid(MCMutexUnlock), &newlyCreatedMutex);
+    MCTransitionType<MCMutexUnlock>::id, &newlyCreatedMutex);
   thread_await_scheduler();
 
   // TODO: What should we do when this fails
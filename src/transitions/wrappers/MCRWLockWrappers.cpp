@@ -12,7 +12,7 @@ mc_pthread_rwlock_init(pthread_rwlock_t *rwlock,
 {
   MCRWLockShadow newLock(rwlock);
   thread_post_visible_operation_hit<MCRWLockShadow>(
-    typeid(MCRWLockInit), &newLock);
+    MCTransitionType<MCRWLockInit>::id, &newLock);
   thread_await_scheduler();
 
   return __real_pthread_rwlock_init(rwlock, attr);
@@ -24,11 +24,11 @@ mc_pthread_rwlock_rdlock(pthread_rwlock_t *rwlock)
   MCRWLockShadow lock(rwlock);
 
   thread_post_visible_operation_hit<MCRWLockShadow>(
-    typeid(MCRWLockReaderEnqueue), &lock);
+    MCTransitionType<MCRWLockReaderEnqueue>::id, &lock);
   thread_await_scheduler();
 
   thread_post_visible_operation_hit<MCRWLockShadow>(
-    typeid(MCRWLockReaderLock), &lock);
+    MCTransitionType<MCRWLockReaderLock>::id, &lock);
   thread_await_scheduler();
 
   return __real_pthread_rwlock_rdlock(rwlock);
@@ -40,11 +40,11 @@ mc_pthread_rwlock_wrlock(pthread_rwlock_t *rwlock)
   MCRWLockShadow lock(rwlock);
 
   thread_post_visible_operation_hit<MCRWLockShadow>(
-    typeid(MCRWLockWriterEnqueue), &lock);
+    MCTransitionType<MCRWLockWriterEnqueue>::id, &lock);
   thread_await_scheduler();
 
   thread_post_visible_operation_hit<MCRWLockShadow>(
-    typeid(MCRWLockWriterLock), &lock);
+    MCTransitionType<MCRWLockWriterLock>::id, &lock);
   thread_await_scheduler();
 
   return __real_pthread_rwlock_wrlock(rwlock);
@@ -55,7 +55,7 @@ mc_pthread_rwlock_unlock(pthread_rwlock_t *rwlock)
 {
   MCRWLockShadow lock(rwlock);
   thread_post_visible_operation_hit<MCRWLockShadow>(
-    typeid(MCRWLockUnlock), &lock);
+    MCTransitionType<MCRWLockUnlock>::id, &lock);
   thread_await_scheduler();
 
   return __real_pthread_rwlock_unlock(rwlock);
@@ -11,7 +11,7 @@ mc_pthread_rwwlock_init(pthread_rwwlock_t *rwwlock)
 {
   MCRWWLockShadow lock(rwwlock);
   thread_post_visible_operation_hit<MCRWWLockShadow>(
-    typeid(MCRWWLockInit), &lock);
+    MCTransitionType<MCRWWLockInit>::id, &lock);
   thread_await_scheduler();
 
   /* Here we can show the power of mcmini -- the true method need not
@@ -24,11 +24,11 @@ mc_pthread_rwwlock_rdlock(pthread_rwwlock_t *rwwlock)
 {
   MCRWWLockShadow lock(rwwlock);
   thread_post_visible_operation_hit<MCRWWLockShadow>(
-    typeid(MCRWWLockReaderEnqueue), &lock);
+    MCTransitionType<MCRWWLockReaderEnqueue>::id, &lock);
   thread_await_scheduler();
 
   thread_post_visible_operation_hit<MCRWWLockShadow>(
-    typeid(MCRWWLockReaderLock), &lock);
+    MCTransitionType<MCRWWLockReaderLock>::id, &lock);
   thread_await_scheduler();
 
   /* Here we can show the power of mcmini -- the true method need not
@@ -41,11 +41,11 @@ mc_pthread_rwwlock_wr1lock(pthread_rwwlock_t *rwwlock)
 {
   MCRWWLockShadow lock(rwwlock);
   thread_post_visible_operation_hit<MCRWWLockShadow>(
-    typeid(MCRWWLockWriter1Enqueue), &lock);
+    MCTransitionType<MCRWWLockWriter1Enqueue>::id, &lock);
   thread_await_scheduler();
 
   thread_post_visible_operation_hit<MCRWWLockShadow>(
-    typeid(MCRWWLockWriter1Lock), &lock);
+    MCTransitionType<MCRWWLockWriter1Lock>::id, &lock);
   thread_await_scheduler();
 
   /* Here we can show the power of mcmini -- the true method need not
@@ -58,11 +58,11 @@ mc_pthread_rwwlock_wr2lock(pthread_rwwlock_t *rwwlock)
 {
   MCRWWLockShadow lock(rwwlock);
   thread_post_visible_operation_hit<MCRWWLockShadow>(
-    typeid(MCRWWLockWriter2Enqueue), &lock);
+    MCTransitionType<MCRWWLockWriter2Enqueue>::id, &lock);
   thread_await_scheduler();
 
   thread_post_visible_operation_hit<MCRWWLockShadow>(
-    typeid(MCRWWLockWriter2Lock), &lock);
+    MCTransitionType<MCRWWLockWriter2Lock>::id, &lock);
   thread_await_scheduler();
 
   /* Here we can show the power of mcmini -- the true method need not
@@ -75,7 +75,7 @@ mc_pthread_rwwlock_unlock(pthread_rwwlock_t *rwwlock)
 {
   MCRWWLockShadow lock(rwwlock);
   thread_post_visible_operation_hit<MCRWWLockShadow>(
-    typeid(MCRWWLockUnlock), &lock);
+    MCTransitionType<MCRWWLockUnlock>::id, &lock);
   thread_await_scheduler();
 
   /* Here we can show the power of mcmini -- the true method need not
@@ -16,7 +16,7 @@ mc_sem_init(sem_t *sem, int pshared, unsigned int count)
   MC_ASSERT(pshared == 0);
   auto newlyCreatedSemaphore = MCSemaphoreShadow(sem, count);
   thread_post_visible_operation_hit<MCSemaphoreShadow>(
-    typeid(MCSemInit), &newlyCreatedSemaphore);
+    MCTransitionType<MCSemInit>::id, &newlyCreatedSemaphore);
   thread_await_scheduler();
   return __real_sem_init(sem, pshared, count);
 }
@@ -24,7 +24,7 @@ mc_sem_init(sem_t *sem, int pshared, unsigned int count)
 int
 mc_sem_post(sem_t *sem)
 {
-  thread_post_visible_operation_hit<sem_t *>(typeid(MCSemPost), &sem);
+  thread_post_visible_operation_hit<sem_t *>(MCTransitionType<MCSemPost>::id, &sem);
   thread_await_scheduler();
   return __real_sem_post(sem);
 }
@@ -32,11 +32,11 @@ mc_sem_post(sem_t *sem)
 int
 mc_sem_wait(sem_t *sem)
 {
-  thread_post_visible_operation_hit<sem_t *>(typeid(MCSemEnqueue),
+  thread_post_visible_operation_hit<sem_t *>(MCTransitionType<MCSemEnqueue>::id,
                                              &sem);
   thread_await_scheduler();
 
-  thread_post_visible_operation_hit<sem_t *>(typeid(MCSemWait), &sem);
+  thread_post_visible_operation_hit<sem_t *>(MCTransitionType<MCSemWait>::id, &sem);
   thread_await_scheduler();
   return __real_sem_wait(sem);
 }
@@ -1,6 +1,7 @@
 #define _GNU_SOURCE
 #include "transitions/wrappers/MCSharedLibraryWrappers.h"
 #include "mcmini_wrappers.h"
+#include <stdarg.h>
 
 typeof(&pthread_create) pthread_create_ptr;
 typeof(&pthread_join) pthread_join_ptr;
@@ -24,6 +25,27 @@ typeof(&pthread_rwlock_rdlock) pthread_rwlock_rdlock_ptr;
 typeof(&pthread_rwlock_wrlock) pthread_rwlock_wrlock_ptr;
 typeof(&pthread_rwlock_unlock) pthread_rwlock_unlock_ptr;
 typeof(&sleep) sleep_ptr;
+typeof(&usleep) usleep_ptr;
+typeof(&nanosleep) nanosleep_ptr;
+typeof(&clock_nanosleep) clock_nanosleep_ptr;
+typeof(&clock_gettime) clock_gettime_ptr;
+typeof(&gettimeofday) gettimeofday_ptr;
+typeof(&time) time_ptr;
+typeof(&pthread_cond_timedwait) pthread_cond_timedwait_ptr;
+typeof(&sem_timedwait) sem_timedwait_ptr;
+typeof(&pthread_mutex_timedlock) pthread_mutex_timedlock_ptr;
+typeof(&getpid) getpid_ptr;
+typeof(&rand) rand_ptr;
+typeof(&random) random_ptr;
+typeof(&getrandom) getrandom_ptr;
+typeof(&read) read_ptr;
+typeof(&open) open_ptr;
+typeof(&open64) open64_ptr;
+typeof(&openat) openat_ptr;
+typeof(&openat64) openat64_ptr;
+typeof(&close) close_ptr;
+typeof(&dup2) dup2_ptr;
+typeof(&dup3) dup3_ptr;
 
 void
 mc_load_intercepted_symbol_addresses()
@@ -54,7 +76,30 @@ mc_load_intercepted_symbol_addresses()
   pthread_cond_signal_ptr = dlsym(RTLD_NEXT, "pthread_cond_signal");
   pthread_cond_broadcast_ptr =
     dlsym(RTLD_NEXT, "pthread_cond_broadcast");
-  sleep_ptr = dlsym(RTLD_NEXT, "sleep");
+  sleep_ptr           = dlsym(RTLD_NEXT, "sleep");
+  usleep_ptr          = dlsym(RTLD_NEXT, "usleep");
+  nanosleep_ptr       = dlsym(RTLD_NEXT, "nanosleep");
+  clock_nanosleep_ptr = dlsym(RTLD_NEXT, "clock_nanosleep");
+  clock_gettime_ptr   = dlsym(RTLD_NEXT, "clock_gettime");
+  gettimeofday_ptr    = dlsym(RTLD_NEXT, "gettimeofday");
+  time_ptr            = dlsym(RTLD_NEXT, "time");
+  pthread_cond_timedwait_ptr =
+    dlsym(RTLD_NEXT, "pthread_cond_timedwait");
+  sem_timedwait_ptr = dlsym(RTLD_NEXT, "sem_timedwait");
+  pthread_mutex_timedlock_ptr =
+    dlsym(RTLD_NEXT, "pthread_mutex_timedlock");
+  getpid_ptr          = dlsym(RTLD_NEXT, "getpid");
+  rand_ptr            = dlsym(RTLD_NEXT, "rand");
+  random_ptr          = dlsym(RTLD_NEXT, "random");
+  getrandom_ptr       = dlsym(RTLD_NEXT, "getrandom");
+  read_ptr            = dlsym(RTLD_NEXT, "read");
+  open_ptr            = dlsym(RTLD_NEXT, "open");
+  open64_ptr          = dlsym(RTLD_NEXT, "open64");
+  openat_ptr          = dlsym(RTLD_NEXT, "openat");
+  openat64_ptr        = dlsym(RTLD_NEXT, "openat64");
+  close_ptr           = dlsym(RTLD_NEXT, "close");
+  dup2_ptr            = dlsym(RTLD_NEXT, "dup2");
+  dup3_ptr            = dlsym(RTLD_NEXT, "dup3");
 #else
   pthread_create_ptr         = &pthread_create;
   pthread_join_ptr           = &pthread_join;
@@ -78,6 +123,27 @@ mc_load_intercepted_symbol_addresses()
   pthread_cond_signal_ptr    = &pthread_cond_signal;
   pthread_cond_broadcast_ptr = &pthread_cond_broadcast;
   sleep_ptr                  = &sleep;
+  usleep_ptr                 = &usleep;
+  nanosleep_ptr              = &nanosleep;
+  clock_nanosleep_ptr        = &clock_nanosleep;
+  clock_gettime_ptr          = &clock_gettime;
+  gettimeofday_ptr           = &gettimeofday;
+  time_ptr                   = &time;
+  pthread_cond_timedwait_ptr  = &pthread_cond_timedwait;
+  sem_timedwait_ptr           = &sem_timedwait;
+  pthread_mutex_timedlock_ptr = &pthread_mutex_timedlock;
+  getpid_ptr                 = &getpid;
+  rand_ptr                   = &rand;
+  random_ptr                 = &random;
+  getrandom_ptr              = &getrandom;
+  read_ptr                   = &read;
+  open_ptr                   = &open;
+  open64_ptr                 = &open64;
+  openat_ptr                 = &openat;
+  openat64_ptr               = &openat64;
+  close_ptr                  = &close;
+  dup2_ptr                   = &dup2;
+  dup3_ptr                   = &dup3;
 #endif
 }
 
@@ -218,8 +284,155 @@ pthread_cond_broadcast(pthread_cond_t *cond)
 unsigned int
 sleep(unsigned int seconds)
 {
-  /* Treat it as if no  time passed */
-  return 0;
+  return mc_sleep(seconds);
+}
+
+int
+usleep(useconds_t usec)
+{
+  return mc_usleep(usec);
+}
+
+int
+nanosleep(const struct timespec *req, struct timespec *rem)
+{
+  return mc_nanosleep(req, rem);
+}
+
+int
+clock_nanosleep(clockid_t clock, int flags, const struct timespec *req,
+                struct timespec *rem)
+{
+  return mc_clock_nanosleep(clock, flags, req, rem);
+}
+
+int
+clock_gettime(clockid_t clock, struct timespec *tp)
+{
+  return mc_clock_gettime(clock, tp);
+}
+
+int
+gettimeofday(struct timeval *tv, void *tz)
+{
+  return mc_gettimeofday(tv, tz);
+}
+
+time_t
+time(time_t *tloc)
+{
+  return mc_time(tloc);
+}
+
+int
+pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+                       const struct timespec *abstime)
+{
+  return mc_pthread_cond_timedwait(cond, mutex, abstime);
+}
+
+int
+sem_timedwait(sem_t *sem, const struct timespec *abstime)
+{
+  return mc_sem_timedwait(sem, abstime);
+}
+
+int
+pthread_mutex_timedlock(pthread_mutex_t *mutex,
+                        const struct timespec *abstime)
+{
+  return mc_pthread_mutex_timedlock(mutex, abstime);
+}
+
+pid_t
+getpid()
+{
+  return mc_getpid();
+}
+
+int
+rand()
+{
+  return mc_rand();
+}
+
+long
+random()
+{
+  return mc_random();
+}
+
+ssize_t
+getrandom(void *buf, size_t len, unsigned int flags)
+{
+  return mc_getrandom(buf, len, flags);
+}
+
+ssize_t
+read(int fd, void *buf, size_t count)
+{
+  return mc_read(fd, buf, count);
+}
+
+/* `mode` is only passed along when the file may be created */
+#define MC_OPEN_MODE(flags, mode)                                      \
+  do {                                                                 \
+    if ((flags) & (O_CREAT | O_TMPFILE)) {                             \
+      va_list args;                                                    \
+      va_start(args, flags);                                           \
+      mode = va_arg(args, mode_t);                                     \
+      va_end(args);                                                    \
+    }                                                                  \
+  } while (0)
+
+int
+open(const char *path, int flags, ...)
+{
+  mode_t mode = 0;
+  MC_OPEN_MODE(flags, mode);
+  return mc_open(path, flags, mode);
+}
+
+int
+open64(const char *path, int flags, ...)
+{
+  mode_t mode = 0;
+  MC_OPEN_MODE(flags, mode);
+  return mc_open64(path, flags, mode);
+}
+
+int
+openat(int dirfd, const char *path, int flags, ...)
+{
+  mode_t mode = 0;
+  MC_OPEN_MODE(flags, mode);
+  return mc_openat(dirfd, path, flags, mode);
+}
+
+int
+openat64(int dirfd, const char *path, int flags, ...)
+{
+  mode_t mode = 0;
+  MC_OPEN_MODE(flags, mode);
+  return mc_openat64(dirfd, path, flags, mode);
+}
+
+int
+close(int fd)
+{
+  return mc_close(fd);
+}
+
+int
+dup2(int oldfd, int newfd)
+{
+  return mc_dup2(oldfd, newfd);
+}
+
+int
+dup3(int oldfd, int newfd, int flags)
+{
+  return mc_dup3(oldfd, newfd, flags);
 }
 
 int
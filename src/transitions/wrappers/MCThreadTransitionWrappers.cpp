@@ -22,6 +22,7 @@ void *
 mc_thread_routine_wrapper(void *arg)
 {
   tid_self = programState->createNewThread();
+  mc_map_trace_sleep_list(tid_self + 1);
   __real_sem_post(&mc_pthread_create_binary_sem);
 
   auto unwrapped_arg = (mc_thread_routine_arg *)arg;
@@ -34,7 +35,7 @@ mc_thread_routine_wrapper(void *arg)
 
   // Simulates being blocked after the thread exits
   // NOTE: Thread exit requires only data about the thread that ran
-  thread_post_visible_operation_hit(typeid(MCThreadFinish));
+  thread_post_visible_operation_hit(MCTransitionType<MCThreadFinish>::id);
   thread_await_scheduler();
 
   // See where the thread_wrapper is created. The memory is malloc'ed
@@ -42,7 +43,7 @@ mc_thread_routine_wrapper(void *arg)
   free(arg);
 
   // NOTE: Thread exit requires only data about the thread that ran
-  thread_post_visible_operation_hit(typeid(MCThreadFinish));
+  thread_post_visible_operation_hit(MCTransitionType<MCThreadFinish>::id);
   thread_awake_scheduler_for_thread_finish_transition();
   return return_value;
 }
@@ -69,7 +70,7 @@ mc_pthread_create(pthread_t *thread, const pthread_attr_t *attr,
   // TODO: When pthread_create fails, *thread is undefined
   auto newlyCreatedThread = MCThreadShadow(arg, routine, *thread);
   thread_post_visible_operation_hit<MCThreadShadow>(
-    typeid(MCThreadCreate), &newlyCreatedThread);
+    MCTransitionType<MCThreadCreate>::id, &newlyCreatedThread);
   thread_await_scheduler();
 
   return return_value;
@@ -81,7 +82,7 @@ mc_pthread_join(pthread_t thread, void **output)
   // The join handler doesn't care about the other arguments
   auto newlyCreatedThread = MCThreadShadow(nullptr, nullptr, thread);
   thread_post_visible_operation_hit<MCThreadShadow>(
-    typeid(MCThreadJoin), &newlyCreatedThread);
+    MCTransitionType<MCThreadJoin>::id, &newlyCreatedThread);
   thread_await_scheduler();
 
   // TODO: What should we do when this fails
@@ -93,7 +94,7 @@ mc_exit_main_thread()
 {
   auto newlyCreatedThread =
     MCThreadShadow(nullptr, nullptr, pthread_self());
-  thread_post_visible_operation_hit(typeid(MCThreadFinish),
+  thread_post_visible_operation_hit(MCTransitionType<MCThreadFinish>::id,
                                     &newlyCreatedThread);
   thread_await_scheduler();
 }
@@ -101,7 +102,7 @@ mc_exit_main_thread()
 MC_NO_RETURN void
 mc_transparent_exit(int status)
 {
-  thread_post_visible_operation_hit(typeid(MCExitTransition),
+  thread_post_visible_operation_hit(MCTransitionType<MCExitTransition>::id,
                                     &status);
   thread_await_scheduler();
   __real_exit(status);
@@ -110,7 +111,7 @@ mc_transparent_exit(int status)
 MC_NO_RETURN void
 mc_transparent_abort()
 {
-  thread_post_visible_operation_hit(typeid(MCAbortTransition));
+  thread_post_visible_operation_hit(MCTransitionType<MCAbortTransition>::id);
   thread_await_scheduler();
   __real_abort();
 }
@@ -120,6 +121,6 @@ void
 mc_pthread_reach_point()
 {
   tid_t thread = tid_self;
-  thread_post_visible_operation_hit(typeid(T), &thread);
+  thread_post_visible_operation_hit(MCTransitionType<T>::id, &thread);
   thread_await_scheduler();
 }
@@ -0,0 +1,263 @@
+#include "transitions/wrappers/MCTimeWrappers.h"
+#include "MCEnv.h"
+#include <atomic>
+
+extern "C" {
+#include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <errno.h>
+#include <stdlib.h>
+}
+
+#define MC_NS_PER_SEC (1000000000ul)
+
+/* Whether traces are to run against the virtual clock */
+static bool virtualTimeEnabled = false;
+
+/* Whether this process is a trace running against the virtual clock */
+static bool virtualTimeActive = false;
+
+/* The real times at which the scheduler started, in nanoseconds */
+static uint64_t realtimeBase  = 0;
+static uint64_t monotonicBase = 0;
+
+/* How far the virtual clock of this trace has advanced, in nanoseconds */
+static std::atomic<uint64_t> virtualElapsed{0};
+
+static uint64_t
+mc_timespec_to_ns(const struct timespec *ts)
+{
+  return (uint64_t)ts->tv_sec * MC_NS_PER_SEC + (uint64_t)ts->tv_nsec;
+}
+
+static void
+mc_ns_to_timespec(uint64_t ns, struct timespec *ts)
+{
+  ts->tv_sec  = (time_t)(ns / MC_NS_PER_SEC);
+  ts->tv_nsec = (long)(ns % MC_NS_PER_SEC);
+}
+
+static bool
+mc_timespec_is_valid(const struct timespec *ts)
+{
+  return ts->tv_sec >= 0 && ts->tv_nsec >= 0 &&
+         (uint64_t)ts->tv_nsec < MC_NS_PER_SEC;
+}
+
+/*
+ * The base of the virtual clock standing in for the given clock, or
+ * false for clocks which are not virtualized (e.g. CPU-time clocks)
+ */
+static bool
+mc_virtual_clock_base(clockid_t clock, uint64_t *base)
+{
+  switch (clock) {
+  case CLOCK_REALTIME:
+  case CLOCK_REALTIME_COARSE:
+  case CLOCK_TAI:
+    *base = realtimeBase;
+    return true;
+  case CLOCK_MONOTONIC:
+  case CLOCK_MONOTONIC_RAW:
+  case CLOCK_MONOTONIC_COARSE:
+  case CLOCK_BOOTTIME:
+    *base = monotonicBase;
+    return true;
+  default:
+    return false;
+  }
+}
+
+static void
+mc_advance_virtual_clock(uint64_t ns)
+{
+  virtualElapsed += ns;
+}
+
+/* Advances the virtual clock to `elapsed`, unless it is already past */
+static void
+mc_advance_virtual_clock_to(uint64_t elapsed)
+{
+  uint64_t now = virtualElapsed;
+  while (now < elapsed &&
+         !virtualElapsed.compare_exchange_weak(now, elapsed))
+    ;
+}
+
+static uint64_t
+mc_read_virtual_clock()
+{
+  return virtualElapsed.fetch_add(MC_VIRTUAL_CLOCK_TICK_NS) +
+         MC_VIRTUAL_CLOCK_TICK_NS;
+}
+
+void
+mc_start_virtual_clock()
+{
+  virtualTimeEnabled = getenv(ENV_NO_VIRTUAL_TIME) == NULL;
+  if (!virtualTimeEnabled) return;
+
+  struct timespec now;
+  __real_clock_gettime(CLOCK_REALTIME, &now);
+  realtimeBase = mc_timespec_to_ns(&now);
+  __real_clock_gettime(CLOCK_MONOTONIC, &now);
+  monotonicBase = mc_timespec_to_ns(&now);
+}
+
+void
+mc_virtualize_trace_time()
+{
+  virtualTimeActive = virtualTimeEnabled;
+  virtualElapsed    = 0;
+}
+
+unsigned int
+mc_sleep(unsigned int seconds)
+{
+  if (!virtualTimeActive) return __real_sleep(seconds);
+  mc_advance_virtual_clock((uint64_t)seconds * MC_NS_PER_SEC);
+  return 0;
+}
+
+int
+mc_usleep(useconds_t usec)
+{
+  if (!virtualTimeActive) return __real_usleep(usec);
+  mc_advance_virtual_clock((uint64_t)usec * 1000);
+  return 0;
+}
+
+int
+mc_nanosleep(const struct timespec *req, struct timespec *rem)
+{
+  if (!virtualTimeActive) return __real_nanosleep(req, rem);
+  if (!mc_timespec_is_valid(req)) {
+    errno = EINVAL;
+    return -1;
+  }
+  mc_advance_virtual_clock(mc_timespec_to_ns(req));
+  return 0;
+}
+
+int
+mc_clock_nanosleep(clockid_t clock, int flags, const struct timespec *req,
+                   struct timespec *rem)
+{
+  uint64_t base;
+  if (!virtualTimeActive || !mc_virtual_clock_base(clock, &base))
+    return __real_clock_nanosleep(clock, flags, req, rem);
+  if (!mc_timespec_is_valid(req)) return EINVAL;
+
+  if (flags & TIMER_ABSTIME) {
+    const uint64_t deadline = mc_timespec_to_ns(req);
+    if (deadline > base) mc_advance_virtual_clock_to(deadline - base);
+  } else {
+    mc_advance_virtual_clock(mc_timespec_to_ns(req));
+  }
+  return 0;
+}
+
+int
+mc_clock_gettime(clockid_t clock, struct timespec *tp)
+{
+  uint64_t base;
+  if (!virtualTimeActive || !mc_virtual_clock_base(clock, &base))
+    return __real_clock_gettime(clock, tp);
+  mc_ns_to_timespec(base + mc_read_virtual_clock(), tp);
+  return 0;
+}
+
+int
+mc_gettimeofday(struct timeval *tv, void *tz)
+{
+  if (!virtualTimeActive) return __real_gettimeofday(tv, tz);
+  struct timespec now;
+  mc_clock_gettime(CLOCK_REALTIME, &now);
+  tv->tv_sec  = now.tv_sec;
+  tv->tv_usec = now.tv_nsec / 1000;
+  if (tz != NULL) {
+    // Obsolete, and always zeroed by Linux
+    ((struct timezone *)tz)->tz_minuteswest = 0;
+    ((struct timezone *)tz)->tz_dsttime     = 0;
+  }
+  return 0;
+}
+
+time_t
+mc_time(time_t *tloc)
+{
+  if (!virtualTimeActive) return __real_time(tloc);
+  struct timespec now;
+  mc_clock_gettime(CLOCK_REALTIME, &now);
+  if (tloc != NULL) *tloc = now.tv_sec;
+  return now.tv_sec;
+}
+
+/*
+ * Moves the deadline of a timed wait from the virtual clock onto the
+ * real one, returning the real time at which the wait begins.
+ *
+ * Both virtual clocks stand ahead of their real counterparts by the
+ * same amount (the time the trace has slept), so the deadline is moved
+ * back by that amount whichever clock it is on
+ */
+static uint64_t
+mc_begin_timed_wait(const struct timespec *abstime, struct timespec *real)
+{
+  struct timespec now;
+  __real_clock_gettime(CLOCK_MONOTONIC, &now);
+  const uint64_t begin       = mc_timespec_to_ns(&now);
+  const uint64_t realElapsed = begin - monotonicBase;
+  const uint64_t virtualNow  = virtualElapsed;
+  const uint64_t deadline    = mc_timespec_to_ns(abstime) + realElapsed;
+  mc_ns_to_timespec(deadline > virtualNow ? deadline - virtualNow : 0, real);
+  return begin;
+}
+
+/* Advances the virtual clock by the real time a timed wait took */
+static void
+mc_end_timed_wait(uint64_t begin)
+{
+  struct timespec now;
+  __real_clock_gettime(CLOCK_MONOTONIC, &now);
+  mc_advance_virtual_clock(mc_timespec_to_ns(&now) - begin);
+}
+
+int
+mc_pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+                          const struct timespec *abstime)
+{
+  if (!virtualTimeActive || !mc_timespec_is_valid(abstime))
+    return __real_pthread_cond_timedwait(cond, mutex, abstime);
+  struct timespec deadline;
+  const uint64_t begin = mc_begin_timed_wait(abstime, &deadline);
+  const int rc = __real_pthread_cond_timedwait(cond, mutex, &deadline);
+  mc_end_timed_wait(begin);
+  return rc;
+}
+
+int
+mc_sem_timedwait(sem_t *sem, const struct timespec *abstime)
+{
+  if (!virtualTimeActive || !mc_timespec_is_valid(abstime))
+    return __real_sem_timedwait(sem, abstime);
+  struct timespec deadline;
+  const uint64_t begin = mc_begin_timed_wait(abstime, &deadline);
+  const int rc         = __real_sem_timedwait(sem, &deadline);
+  const int waitErrno  = errno;
+  mc_end_timed_wait(begin);
+  errno = waitErrno;
+  return rc;
+}
+
+int
+mc_pthread_mutex_timedlock(pthread_mutex_t *mutex,
+                           const struct timespec *abstime)
+{
+  if (!virtualTimeActive || !mc_timespec_is_valid(abstime))
+    return __real_pthread_mutex_timedlock(mutex, abstime);
+  struct timespec deadline;
+  const uint64_t begin = mc_begin_timed_wait(abstime, &deadline);
+  const int rc = __real_pthread_mutex_timedlock(mutex, &deadline);
+  mc_end_timed_wait(begin);
+  return rc;
+}
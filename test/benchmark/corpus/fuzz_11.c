@@ -0,0 +1,110 @@
+// Generated by mcmini-fuzz (seed 11): rwlock, rwwlock, shared
+
+#include <assert.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include "../../program/reader_writer/rwwlock.h"
+
+#define NUM_RWLOCKS 1
+#define NUM_RWWLOCKS 1
+#define NUM_SHARED 1
+pthread_rwlock_t rwlock[NUM_RWLOCKS];
+int rwlock_readers[NUM_RWLOCKS];
+int rwlock_writer[NUM_RWLOCKS];
+
+void read_lock(int r) {
+    pthread_rwlock_rdlock(&rwlock[r]);
+    assert(!rwlock_writer[r]);
+    rwlock_readers[r]++;
+}
+
+void write_lock(int r) {
+    pthread_rwlock_wrlock(&rwlock[r]);
+    assert(!rwlock_writer[r] && rwlock_readers[r] == 0);
+    rwlock_writer[r] = 1;
+}
+
+void rw_unlock(int r, int writer) {
+    if (writer)
+        rwlock_writer[r] = 0;
+    else
+        rwlock_readers[r]--;
+    pthread_rwlock_unlock(&rwlock[r]);
+}
+
+pthread_rwwlock_t rwwlock[NUM_RWWLOCKS];
+int rwwlock_readers[NUM_RWWLOCKS];
+int rwwlock_writer[NUM_RWWLOCKS];
+
+void rww_lock(int r, int writer) {
+    if (writer == 0)
+        pthread_rwwlock_rdlock(&rwwlock[r]);
+    else if (writer == 1)
+        pthread_rwwlock_wr1lock(&rwwlock[r]);
+    else
+        pthread_rwwlock_wr2lock(&rwwlock[r]);
+    assert(!rwwlock_writer[r]);
+    if (writer) {
+        assert(rwwlock_readers[r] == 0);
+        rwwlock_writer[r] = writer;
+    } else {
+        rwwlock_readers[r]++;
+    }
+}
+
+void rww_unlock(int r, int writer) {
+    if (writer)
+        rwwlock_writer[r] = 0;
+    else
+        rwwlock_readers[r]--;
+    pthread_rwwlock_unlock(&rwwlock[r]);
+}
+
+extern void *mcmini_read(void *) __attribute__((weak));
+extern void mcmini_write(void *, void *) __attribute__((weak));
+
+long shared[NUM_SHARED];
+
+long read_shared(int g) {
+    if (mcmini_read) mcmini_read(&shared[g]);
+    return shared[g];
+}
+
+void write_shared(int g, long value) {
+    if (mcmini_write) mcmini_write(&shared[g], (void *)value);
+    shared[g] = value;
+}
+
+void *thread_1(void *notused) {
+    rww_lock(0, 1);
+    write_shared(0, 7);
+    rww_unlock(0, 1);
+    return NULL;
+}
+
+void *thread_2(void *notused) {
+    read_lock(0);
+    rw_unlock(0, 0);
+    read_lock(0);
+    write_shared(0, 1);
+    rw_unlock(0, 0);
+    rww_lock(0, 1);
+    write_shared(0, 5);
+    rww_unlock(0, 1);
+    rww_lock(0, 0);
+    rww_unlock(0, 0);
+    return NULL;
+}
+
+int main() {
+    pthread_rwlock_init(&rwlock[0], NULL);
+    pthread_rwwlock_init(&rwwlock[0]);
+
+    pthread_t threads[2];
+    pthread_create(&threads[0], NULL, thread_1, NULL);
+    pthread_create(&threads[1], NULL, thread_2, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Generated by mcmini-fuzz (seed 15): mutex, rwwlock
+
+#include <assert.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include "../../program/reader_writer/rwwlock.h"
+
+#define NUM_MUTEXES 1
+#define NUM_RWWLOCKS 1
+pthread_mutex_t mutex[NUM_MUTEXES];
+int mutex_holder[NUM_MUTEXES];
+
+void lock(int m, int self) {
+    pthread_mutex_lock(&mutex[m]);
+    assert(mutex_holder[m] == 0);
+    mutex_holder[m] = self;
+}
+
+void unlock(int m) {
+    mutex_holder[m] = 0;
+    pthread_mutex_unlock(&mutex[m]);
+}
+
+pthread_rwwlock_t rwwlock[NUM_RWWLOCKS];
+int rwwlock_readers[NUM_RWWLOCKS];
+int rwwlock_writer[NUM_RWWLOCKS];
+
+void rww_lock(int r, int writer) {
+    if (writer == 0)
+        pthread_rwwlock_rdlock(&rwwlock[r]);
+    else if (writer == 1)
+        pthread_rwwlock_wr1lock(&rwwlock[r]);
+    else
+        pthread_rwwlock_wr2lock(&rwwlock[r]);
+    assert(!rwwlock_writer[r]);
+    if (writer) {
+        assert(rwwlock_readers[r] == 0);
+        rwwlock_writer[r] = writer;
+    } else {
+        rwwlock_readers[r]++;
+    }
+}
+
+void rww_unlock(int r, int writer) {
+    if (writer)
+        rwwlock_writer[r] = 0;
+    else
+        rwwlock_readers[r]--;
+    pthread_rwwlock_unlock(&rwwlock[r]);
+}
+
+void *thread_1(void *notused) {
+    rww_lock(0, 0);
+    rww_unlock(0, 0);
+    lock(0, 1);
+    unlock(0);
+    return NULL;
+}
+
+void *thread_2(void *notused) {
+    rww_lock(0, 1);
+    rww_unlock(0, 1);
+    rww_lock(0, 1);
+    rww_unlock(0, 1);
+    rww_lock(0, 0);
+    rww_unlock(0, 0);
+    lock(0, 2);
+    unlock(0);
+    return NULL;
+}
+
+int main() {
+    pthread_mutex_init(&mutex[0], NULL);
+    pthread_rwwlock_init(&rwwlock[0]);
+
+    pthread_t threads[2];
+    pthread_create(&threads[0], NULL, thread_1, NULL);
+    pthread_create(&threads[1], NULL, thread_2, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Generated by mcmini-fuzz (seed 16): cond, mutex, rwlock, shared
+
+#include <assert.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+
+#define NUM_MUTEXES 2
+#define NUM_CONDS 1
+#define NUM_RWLOCKS 1
+#define NUM_SHARED 1
+pthread_mutex_t mutex[NUM_MUTEXES];
+int mutex_holder[NUM_MUTEXES];
+
+void lock(int m, int self) {
+    pthread_mutex_lock(&mutex[m]);
+    assert(mutex_holder[m] == 0);
+    mutex_holder[m] = self;
+}
+
+void unlock(int m) {
+    mutex_holder[m] = 0;
+    pthread_mutex_unlock(&mutex[m]);
+}
+
+pthread_cond_t cond[NUM_CONDS];
+int cond_flag[NUM_CONDS];
+
+void await(int c, int m, int self) {
+    lock(m, self);
+    while (!cond_flag[c]) {
+        mutex_holder[m] = 0;
+        pthread_cond_wait(&cond[c], &mutex[m]);
+        assert(mutex_holder[m] == 0);
+        mutex_holder[m] = self;
+    }
+    unlock(m);
+}
+
+void notify(int c, int m, int self, int broadcast) {
+    lock(m, self);
+    cond_flag[c] = 1;
+    if (broadcast)
+        pthread_cond_broadcast(&cond[c]);
+    else
+        pthread_cond_signal(&cond[c]);
+    unlock(m);
+}
+
+pthread_rwlock_t rwlock[NUM_RWLOCKS];
+int rwlock_readers[NUM_RWLOCKS];
+int rwlock_writer[NUM_RWLOCKS];
+
+void read_lock(int r) {
+    pthread_rwlock_rdlock(&rwlock[r]);
+    assert(!rwlock_writer[r]);
+    rwlock_readers[r]++;
+}
+
+void write_lock(int r) {
+    pthread_rwlock_wrlock(&rwlock[r]);
+    assert(!rwlock_writer[r] && rwlock_readers[r] == 0);
+    rwlock_writer[r] = 1;
+}
+
+void rw_unlock(int r, int writer) {
+    if (writer)
+        rwlock_writer[r] = 0;
+    else
+        rwlock_readers[r]--;
+    pthread_rwlock_unlock(&rwlock[r]);
+}
+
+extern void *mcmini_read(void *) __attribute__((weak));
+extern void mcmini_write(void *, void *) __attribute__((weak));
+
+long shared[NUM_SHARED];
+
+long read_shared(int g) {
+    if (mcmini_read) mcmini_read(&shared[g]);
+    return shared[g];
+}
+
+void write_shared(int g, long value) {
+    if (mcmini_write) mcmini_write(&shared[g], (void *)value);
+    shared[g] = value;
+}
+
+void *thread_1(void *notused) {
+    read_shared(0);
+    notify(0, 0, 1, 0);
+    read_shared(0);
+    return NULL;
+}
+
+void *thread_2(void *notused) {
+    await(0, 0, 2);
+    read_shared(0);
+    return NULL;
+}
+
+void *thread_3(void *notused) {
+    read_shared(0);
+    lock(0, 3);
+    write_shared(0, 3);
+    unlock(0);
+    notify(0, 0, 3, 1);
+    return NULL;
+}
+
+int main() {
+    pthread_mutex_init(&mutex[0], NULL);
+    pthread_mutex_init(&mutex[1], NULL);
+    pthread_cond_init(&cond[0], NULL);
+    pthread_rwlock_init(&rwlock[0], NULL);
+
+    pthread_t threads[3];
+    pthread_create(&threads[0], NULL, thread_1, NULL);
+    pthread_create(&threads[1], NULL, thread_2, NULL);
+    pthread_create(&threads[2], NULL, thread_3, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[2], NULL);
+    return 0;
+}
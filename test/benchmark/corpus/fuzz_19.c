@@ -0,0 +1,130 @@
+// Generated by mcmini-fuzz (seed 19): mutex, rwwlock, sem, shared
+
+#include <assert.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include "../../program/reader_writer/rwwlock.h"
+
+#define NUM_MUTEXES 2
+#define NUM_SEMS 1
+#define NUM_RWWLOCKS 1
+#define NUM_SHARED 2
+pthread_mutex_t mutex[NUM_MUTEXES];
+int mutex_holder[NUM_MUTEXES];
+
+void lock(int m, int self) {
+    pthread_mutex_lock(&mutex[m]);
+    assert(mutex_holder[m] == 0);
+    mutex_holder[m] = self;
+}
+
+void unlock(int m) {
+    mutex_holder[m] = 0;
+    pthread_mutex_unlock(&mutex[m]);
+}
+
+sem_t sem[NUM_SEMS];
+int sem_value[NUM_SEMS];
+
+void post_sem(int s) {
+    sem_value[s]++;
+    sem_post(&sem[s]);
+}
+
+void wait_sem(int s) {
+    sem_wait(&sem[s]);
+    assert(sem_value[s] > 0);
+    sem_value[s]--;
+}
+
+pthread_rwwlock_t rwwlock[NUM_RWWLOCKS];
+int rwwlock_readers[NUM_RWWLOCKS];
+int rwwlock_writer[NUM_RWWLOCKS];
+
+void rww_lock(int r, int writer) {
+    if (writer == 0)
+        pthread_rwwlock_rdlock(&rwwlock[r]);
+    else if (writer == 1)
+        pthread_rwwlock_wr1lock(&rwwlock[r]);
+    else
+        pthread_rwwlock_wr2lock(&rwwlock[r]);
+    assert(!rwwlock_writer[r]);
+    if (writer) {
+        assert(rwwlock_readers[r] == 0);
+        rwwlock_writer[r] = writer;
+    } else {
+        rwwlock_readers[r]++;
+    }
+}
+
+void rww_unlock(int r, int writer) {
+    if (writer)
+        rwwlock_writer[r] = 0;
+    else
+        rwwlock_readers[r]--;
+    pthread_rwwlock_unlock(&rwwlock[r]);
+}
+
+extern void *mcmini_read(void *) __attribute__((weak));
+extern void mcmini_write(void *, void *) __attribute__((weak));
+
+long shared[NUM_SHARED];
+
+long read_shared(int g) {
+    if (mcmini_read) mcmini_read(&shared[g]);
+    return shared[g];
+}
+
+void write_shared(int g, long value) {
+    if (mcmini_write) mcmini_write(&shared[g], (void *)value);
+    shared[g] = value;
+}
+
+void *thread_1(void *notused) {
+    read_shared(1);
+    return NULL;
+}
+
+void *thread_2(void *notused) {
+    lock(1, 2);
+    lock(0, 2);
+    unlock(0);
+    unlock(1);
+    rww_lock(0, 0);
+    rww_unlock(0, 0);
+    lock(1, 2);
+    lock(0, 2);
+    write_shared(0, 7);
+    unlock(0);
+    unlock(1);
+    return NULL;
+}
+
+void *thread_3(void *notused) {
+    wait_sem(0);
+    write_shared(0, 7);
+    rww_lock(0, 2);
+    rww_unlock(0, 2);
+    lock(0, 3);
+    read_shared(0);
+    unlock(0);
+    return NULL;
+}
+
+int main() {
+    pthread_mutex_init(&mutex[0], NULL);
+    pthread_mutex_init(&mutex[1], NULL);
+    sem_init(&sem[0], 0, 1);
+    sem_value[0] = 1;
+    pthread_rwwlock_init(&rwwlock[0]);
+
+    pthread_t threads[3];
+    pthread_create(&threads[0], NULL, thread_1, NULL);
+    pthread_create(&threads[1], NULL, thread_2, NULL);
+    pthread_create(&threads[2], NULL, thread_3, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[2], NULL);
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Generated by mcmini-fuzz (seed 20): barrier, cond, mutex, sem
+
+#include <assert.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+
+#define NUM_MUTEXES 2
+#define NUM_SEMS 1
+#define NUM_CONDS 1
+#define NUM_BARRIERS 1
+pthread_mutex_t mutex[NUM_MUTEXES];
+int mutex_holder[NUM_MUTEXES];
+
+void lock(int m, int self) {
+    pthread_mutex_lock(&mutex[m]);
+    assert(mutex_holder[m] == 0);
+    mutex_holder[m] = self;
+}
+
+void unlock(int m) {
+    mutex_holder[m] = 0;
+    pthread_mutex_unlock(&mutex[m]);
+}
+
+sem_t sem[NUM_SEMS];
+int sem_value[NUM_SEMS];
+
+void post_sem(int s) {
+    sem_value[s]++;
+    sem_post(&sem[s]);
+}
+
+void wait_sem(int s) {
+    sem_wait(&sem[s]);
+    assert(sem_value[s] > 0);
+    sem_value[s]--;
+}
+
+pthread_cond_t cond[NUM_CONDS];
+int cond_flag[NUM_CONDS];
+
+void await(int c, int m, int self) {
+    lock(m, self);
+    while (!cond_flag[c]) {
+        mutex_holder[m] = 0;
+        pthread_cond_wait(&cond[c], &mutex[m]);
+        assert(mutex_holder[m] == 0);
+        mutex_holder[m] = self;
+    }
+    unlock(m);
+}
+
+void notify(int c, int m, int self, int broadcast) {
+    lock(m, self);
+    cond_flag[c] = 1;
+    if (broadcast)
+        pthread_cond_broadcast(&cond[c]);
+    else
+        pthread_cond_signal(&cond[c]);
+    unlock(m);
+}
+
+pthread_barrier_t barrier[NUM_BARRIERS];
+int barrier_arrived[NUM_BARRIERS];
+
+void cross(int b, int count) {
+    barrier_arrived[b]++;
+    pthread_barrier_wait(&barrier[b]);
+    assert(barrier_arrived[b] >= count);
+}
+
+void *thread_1(void *notused) {
+    cross(0, 1);
+    return NULL;
+}
+
+void *thread_2(void *notused) {
+    notify(0, 1, 2, 0);
+    lock(1, 2);
+    lock(0, 2);
+    unlock(0);
+    unlock(1);
+    return NULL;
+}
+
+void *thread_3(void *notused) {
+    notify(0, 1, 3, 0);
+    lock(0, 3);
+    unlock(0);
+    lock(1, 3);
+    lock(0, 3);
+    unlock(0);
+    unlock(1);
+    return NULL;
+}
+
+int main() {
+    pthread_mutex_init(&mutex[0], NULL);
+    pthread_mutex_init(&mutex[1], NULL);
+    sem_init(&sem[0], 0, 0);
+    sem_value[0] = 0;
+    pthread_cond_init(&cond[0], NULL);
+    pthread_barrier_init(&barrier[0], NULL, 1);
+
+    pthread_t threads[3];
+    pthread_create(&threads[0], NULL, thread_1, NULL);
+    pthread_create(&threads[1], NULL, thread_2, NULL);
+    pthread_create(&threads[2], NULL, thread_3, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[2], NULL);
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Generated by mcmini-fuzz (seed 30): cond, mutex, rwwlock, shared
+
+#include <assert.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include "../../program/reader_writer/rwwlock.h"
+
+#define NUM_MUTEXES 1
+#define NUM_CONDS 1
+#define NUM_RWWLOCKS 1
+#define NUM_SHARED 2
+pthread_mutex_t mutex[NUM_MUTEXES];
+int mutex_holder[NUM_MUTEXES];
+
+void lock(int m, int self) {
+    pthread_mutex_lock(&mutex[m]);
+    assert(mutex_holder[m] == 0);
+    mutex_holder[m] = self;
+}
+
+void unlock(int m) {
+    mutex_holder[m] = 0;
+    pthread_mutex_unlock(&mutex[m]);
+}
+
+pthread_cond_t cond[NUM_CONDS];
+int cond_flag[NUM_CONDS];
+
+void await(int c, int m, int self) {
+    lock(m, self);
+    while (!cond_flag[c]) {
+        mutex_holder[m] = 0;
+        pthread_cond_wait(&cond[c], &mutex[m]);
+        assert(mutex_holder[m] == 0);
+        mutex_holder[m] = self;
+    }
+    unlock(m);
+}
+
+void notify(int c, int m, int self, int broadcast) {
+    lock(m, self);
+    cond_flag[c] = 1;
+    if (broadcast)
+        pthread_cond_broadcast(&cond[c]);
+    else
+        pthread_cond_signal(&cond[c]);
+    unlock(m);
+}
+
+pthread_rwwlock_t rwwlock[NUM_RWWLOCKS];
+int rwwlock_readers[NUM_RWWLOCKS];
+int rwwlock_writer[NUM_RWWLOCKS];
+
+void rww_lock(int r, int writer) {
+    if (writer == 0)
+        pthread_rwwlock_rdlock(&rwwlock[r]);
+    else if (writer == 1)
+        pthread_rwwlock_wr1lock(&rwwlock[r]);
+    else
+        pthread_rwwlock_wr2lock(&rwwlock[r]);
+    assert(!rwwlock_writer[r]);
+    if (writer) {
+        assert(rwwlock_readers[r] == 0);
+        rwwlock_writer[r] = writer;
+    } else {
+        rwwlock_readers[r]++;
+    }
+}
+
+void rww_unlock(int r, int writer) {
+    if (writer)
+        rwwlock_writer[r] = 0;
+    else
+        rwwlock_readers[r]--;
+    pthread_rwwlock_unlock(&rwwlock[r]);
+}
+
+extern void *mcmini_read(void *) __attribute__((weak));
+extern void mcmini_write(void *, void *) __attribute__((weak));
+
+long shared[NUM_SHARED];
+
+long read_shared(int g) {
+    if (mcmini_read) mcmini_read(&shared[g]);
+    return shared[g];
+}
+
+void write_shared(int g, long value) {
+    if (mcmini_write) mcmini_write(&shared[g], (void *)value);
+    shared[g] = value;
+}
+
+void *thread_1(void *notused) {
+    read_shared(1);
+    await(0, 0, 1);
+    return NULL;
+}
+
+void *thread_2(void *notused) {
+    notify(0, 0, 2, 1);
+    return NULL;
+}
+
+void *thread_3(void *notused) {
+    rww_lock(0, 2);
+    rww_unlock(0, 2);
+    lock(0, 3);
+    write_shared(1, 2);
+    unlock(0);
+    rww_lock(0, 2);
+    rww_unlock(0, 2);
+    write_shared(1, 3);
+    return NULL;
+}
+
+int main() {
+    pthread_mutex_init(&mutex[0], NULL);
+    pthread_cond_init(&cond[0], NULL);
+    pthread_rwwlock_init(&rwwlock[0]);
+
+    pthread_t threads[3];
+    pthread_create(&threads[0], NULL, thread_1, NULL);
+    pthread_create(&threads[1], NULL, thread_2, NULL);
+    pthread_create(&threads[2], NULL, thread_3, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[2], NULL);
+    return 0;
+}
@@ -0,0 +1,84 @@
+# What the benchmark drivers next to this file (mcmini-bench,
+# mcmini-sweep) share: building the programs of test/ and reading what
+# McMini's stream of results (see '--results-fd') says of a run.
+
+import json
+import os
+import re
+import subprocess
+import tempfile
+
+bench_dir = os.path.dirname(os.path.abspath(__file__))
+test_dir = os.path.dirname(bench_dir)
+mcmini = os.path.join(os.path.dirname(test_dir), "mcmini")
+bin_dir = os.path.join(bench_dir, "bin")
+
+def build(program):
+  """The executable of a program of test/, built if out of date.  The
+     sources of the local headers it includes (e.g. rwwlock.c) are built
+     into shared libraries it links with: the definitions of the
+     executable itself would win over those of McMini, preloaded"""
+  source = os.path.join(test_dir, program + ".c")
+  libraries = []
+  with open(source) as f:
+    for header in re.findall(r'#include\s+"([^"]+)\.h"', f.read()):
+      extra = os.path.normpath(os.path.join(os.path.dirname(source),
+                                            header + ".c"))
+      if os.path.exists(extra):
+        libraries.append(extra)
+  os.makedirs(bin_dir, exist_ok=True)
+  link = []
+  for library in libraries:
+    name = os.path.splitext(os.path.basename(library))[0]
+    make([library], os.path.join(bin_dir, "lib%s.so" % name),
+         ["-shared", "-fPIC"])
+    link += ["-L" + bin_dir, "-l" + name, "-Wl,-rpath=" + bin_dir]
+  executable = os.path.join(bin_dir, program.replace('/', '-'))
+  make([source] + libraries, executable, [], link)
+  return executable
+
+def make(sources, target, flags, link=[]):
+  """Compiles the first of the sources into the target, unless it is
+     newer than all of them"""
+  if os.path.exists(target) and \
+     os.path.getmtime(target) >= max(map(os.path.getmtime, sources)):
+    return
+  subprocess.run(["gcc", "-g", "-O0", "-pthread"] + flags +
+                 ["-o", target, sources[0]] + link, check=True)
+
+def split_options(options):
+  """McMini options apart from the environment variables (VAR=value)
+     among them, and the environment to run McMini in"""
+  env = dict(os.environ)
+  mcmini_options = []
+  for option in options:
+    if '=' in option and not option.startswith('-'):
+      var, value = option.split('=', 1)
+      env[var] = value
+    else:
+      mcmini_options.append(option)
+  return mcmini_options, env
+
+def run_mcmini(options, program, program_args, timeout, env=None):
+  """The summary McMini streams for a run over a program of test/, or
+     None if the run did not finish (in time)"""
+  events = stream_mcmini(options, program, program_args, timeout, env)
+  summaries = [event for event in events or []
+               if event["event"] == "summary"]
+  return summaries[-1] if summaries else None
+
+def stream_mcmini(options, program, program_args, timeout, env=None):
+  """Every event McMini streams for a run over a program of test/, or
+     None if the run did not finish in time"""
+  with tempfile.TemporaryFile() as results:
+    cmd = [mcmini, "-q", "--results-fd", str(results.fileno())] + \
+          options + [build(program)] + program_args
+    try:
+      subprocess.run(cmd, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL,
+                     stderr=subprocess.DEVNULL, pass_fds=[results.fileno()],
+                     timeout=timeout, env=env)
+    except subprocess.TimeoutExpired:
+      return None
+    results.seek(0)
+    return [json.loads(line) for line in results.read().decode().split('\n')
+            if line.startswith('{')]
@@ -0,0 +1,421 @@
+/*
+ * Times the DPOR engine of McMini on its own, without a target: an
+ * `MCStack` explores a synthetic program, standing in for the trace
+ * process by writing each thread's next operation into the mailbox the
+ * way the wrappers of a real target would.
+ *
+ * The synthetic program is a main thread which initializes the objects,
+ * creates the worker threads and joins them. Each worker repeats one of
+ * a few patterns `depth` times:
+ *
+ *  - mutex: lock and unlock one of the mutexes
+ *  - sem:   half the workers post to a semaphore, the other half wait
+ *  - cond:  the first worker waits on a condition variable, the others
+ *           signal it, all under one mutex (which may deadlock)
+ *
+ * The exploration follows `mc_explore_branch()`, timing each call into
+ * `MCStack`, and ns per operation is reported for each.
+ *
+ * Usage: mcstack_bench [-p mutex|sem|cond|all] [-n <threads>]
+ *                      [-d <depth>] [-o <objects>] [-t <max traces>]
+ *                      [-m <max depth per thread>]
+ *
+ * NOTE: Built by 'make bench-stack' from objects compiled without
+ * MC_SHARED_LIBRARY, so that nothing is interposed and McMini does not
+ * start as the benchmark is loaded.
+ */
+
+#include "mcmini_private.h"
+#include "transitions/cond/MCCondEnqueue.h"
+#include "transitions/cond/MCCondInit.h"
+#include "transitions/cond/MCCondSignal.h"
+#include "transitions/cond/MCCondWait.h"
+#include "transitions/mutex/MCMutexInit.h"
+#include "transitions/mutex/MCMutexLock.h"
+#include "transitions/mutex/MCMutexUnlock.h"
+#include "transitions/semaphore/MCSemEnqueue.h"
+#include "transitions/semaphore/MCSemInit.h"
+#include "transitions/semaphore/MCSemPost.h"
+#include "transitions/semaphore/MCSemWait.h"
+#include "transitions/threads/MCThreadCreate.h"
+#include "transitions/threads/MCThreadFinish.h"
+#include "transitions/threads/MCThreadJoin.h"
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "transitions/wrappers/MCSharedLibraryWrappers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+}
+
+#define MC_BENCH_MAX_THREADS (64)
+#define MC_BENCH_MAX_OBJECTS (64)
+
+enum mc_bench_op_kind {
+  MC_BENCH_MUTEX_INIT,
+  MC_BENCH_MUTEX_LOCK,
+  MC_BENCH_MUTEX_UNLOCK,
+  MC_BENCH_SEM_INIT,
+  MC_BENCH_SEM_POST,
+  MC_BENCH_SEM_ENQUEUE,
+  MC_BENCH_SEM_WAIT,
+  MC_BENCH_COND_INIT,
+  MC_BENCH_COND_SIGNAL,
+  MC_BENCH_COND_ENQUEUE,
+  MC_BENCH_COND_WAIT,
+  MC_BENCH_THREAD_CREATE,
+  MC_BENCH_THREAD_JOIN,
+  MC_BENCH_THREAD_FINISH,
+};
+
+struct mc_bench_op {
+  mc_bench_op_kind kind;
+  int object;
+};
+
+/* The objects of the synthetic program. Only their addresses matter:
+ * they are the system identities of the objects in the model */
+static pthread_mutex_t benchMutexes[MC_BENCH_MAX_OBJECTS];
+static sem_t benchSems[MC_BENCH_MAX_OBJECTS];
+static pthread_cond_t benchConds[MC_BENCH_MAX_OBJECTS];
+static char benchThreads[MC_BENCH_MAX_THREADS];
+
+/* The operations of each thread; the first, that the thread starts, is
+ * never posted, and the last (the thread finishing) is posted again
+ * once run, as `mc_thread_routine_wrapper()` does */
+static std::vector<mc_bench_op> programOps[MC_BENCH_MAX_THREADS];
+
+/* How many operations each thread has run in the current trace */
+static uint64_t opsRun[MC_BENCH_MAX_THREADS];
+
+enum mc_bench_phase {
+  MC_BENCH_SIMULATE,
+  MC_BENCH_BACKTRACK,
+  MC_BENCH_CHECKS,
+  MC_BENCH_REFLECT,
+  MC_BENCH_PHASE_COUNT
+};
+
+static const char *const phaseNames[MC_BENCH_PHASE_COUNT] = {
+  "simulateRunningTransition", "dynamicallyUpdateBacktrackSets",
+  "races+firstEnabled", "reflectStateAtTransitionIndex"};
+
+static uint64_t phaseNs[MC_BENCH_PHASE_COUNT];
+static uint64_t phaseCalls[MC_BENCH_PHASE_COUNT];
+
+static uint64_t
+mc_bench_now()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void
+mc_bench_add_op(tid_t tid, mc_bench_op_kind kind, int object)
+{
+  programOps[tid].push_back(mc_bench_op{kind, object});
+}
+
+/*
+ * Lays out the synthetic program for the given pattern
+ */
+static void
+mc_bench_build_program(const char *pattern, int workers, int depth,
+                       int objects)
+{
+  for (int tid = 0; tid <= workers; tid++) {
+    programOps[tid].clear();
+    mc_bench_add_op(tid, MC_BENCH_THREAD_FINISH, 0); // Stands for "starts"
+  }
+
+  const bool cond = strcmp(pattern, "cond") == 0;
+  const bool sem  = strcmp(pattern, "sem") == 0;
+  for (int i = 0; i < objects; i++) {
+    if (sem) {
+      mc_bench_add_op(0, MC_BENCH_SEM_INIT, i);
+    } else {
+      mc_bench_add_op(0, MC_BENCH_MUTEX_INIT, i);
+      if (cond) mc_bench_add_op(0, MC_BENCH_COND_INIT, i);
+    }
+  }
+  for (int k = 1; k <= workers; k++)
+    mc_bench_add_op(0, MC_BENCH_THREAD_CREATE, k);
+  for (int k = 1; k <= workers; k++)
+    mc_bench_add_op(0, MC_BENCH_THREAD_JOIN, k);
+  mc_bench_add_op(0, MC_BENCH_THREAD_FINISH, 0);
+
+  for (int k = 1; k <= workers; k++) {
+    for (int i = 0; i < depth; i++) {
+      if (sem) {
+        const int s = ((k - 1) / 2) % objects;
+        if (k % 2 == 1) {
+          mc_bench_add_op(k, MC_BENCH_SEM_POST, s);
+        } else {
+          mc_bench_add_op(k, MC_BENCH_SEM_ENQUEUE, s);
+          mc_bench_add_op(k, MC_BENCH_SEM_WAIT, s);
+        }
+      } else if (cond) {
+        mc_bench_add_op(k, MC_BENCH_MUTEX_LOCK, 0);
+        if (k == 1) {
+          mc_bench_add_op(k, MC_BENCH_COND_ENQUEUE, 0);
+          mc_bench_add_op(k, MC_BENCH_COND_WAIT, 0);
+        } else {
+          mc_bench_add_op(k, MC_BENCH_COND_SIGNAL, 0);
+        }
+        mc_bench_add_op(k, MC_BENCH_MUTEX_UNLOCK, 0);
+      } else {
+        const int m = (k + i) % objects;
+        mc_bench_add_op(k, MC_BENCH_MUTEX_LOCK, m);
+        mc_bench_add_op(k, MC_BENCH_MUTEX_UNLOCK, m);
+      }
+    }
+    mc_bench_add_op(k, MC_BENCH_THREAD_FINISH, 0);
+  }
+}
+
+template<typename Transition, typename SharedMemoryData>
+static void
+mc_bench_post(tid_t tid, const SharedMemoryData &data)
+{
+  auto typeInfo = MCSharedTransition(tid, MCTransitionType<Transition>::id);
+  memcpy((char *)shmTransitionTypeInfo, (char *)&typeInfo,
+         sizeof(MCSharedTransition));
+  memcpy((char *)shmTransitionData, (char *)&data, sizeof(data));
+}
+
+/*
+ * Writes the next operation of the thread into the mailbox, as its
+ * wrapper would in a trace
+ */
+static void
+mc_bench_post_next_op(tid_t tid)
+{
+  const std::vector<mc_bench_op> &ops = programOps[tid];
+  const mc_bench_op &op =
+    ops[opsRun[tid] < ops.size() ? opsRun[tid] : ops.size() - 1];
+  pthread_mutex_t *mutex = &benchMutexes[op.object];
+  sem_t *sem             = &benchSems[op.object];
+  pthread_cond_t *cond   = &benchConds[op.object];
+  const pthread_t thread = (pthread_t)&benchThreads[op.object];
+
+  switch (op.kind) {
+  case MC_BENCH_MUTEX_INIT:
+    mc_bench_post<MCMutexInit>(tid, MCMutexShadow(mutex));
+    break;
+  case MC_BENCH_MUTEX_LOCK:
+    mc_bench_post<MCMutexLock>(tid, MCMutexShadow(mutex));
+    break;
+  case MC_BENCH_MUTEX_UNLOCK:
+    mc_bench_post<MCMutexUnlock>(tid, MCMutexShadow(mutex));
+    break;
+  case MC_BENCH_SEM_INIT:
+    mc_bench_post<MCSemInit>(tid, MCSemaphoreShadow(sem, 0));
+    break;
+  case MC_BENCH_SEM_POST:
+    mc_bench_post<MCSemPost>(tid, sem);
+    break;
+  case MC_BENCH_SEM_ENQUEUE:
+    mc_bench_post<MCSemEnqueue>(tid, sem);
+    break;
+  case MC_BENCH_SEM_WAIT:
+    mc_bench_post<MCSemWait>(tid, sem);
+    break;
+  case MC_BENCH_COND_INIT:
+    mc_bench_post<MCCondInit>(tid, cond);
+    break;
+  case MC_BENCH_COND_SIGNAL:
+    mc_bench_post<MCCondSignal>(tid, cond);
+    break;
+  case MC_BENCH_COND_ENQUEUE:
+    mc_bench_post<MCCondEnqueue>(
+      tid, MCSharedMemoryConditionVariable(cond, &benchMutexes[0]));
+    break;
+  case MC_BENCH_COND_WAIT:
+    mc_bench_post<MCCondWait>(
+      tid, MCSharedMemoryConditionVariable(cond, &benchMutexes[0]));
+    break;
+  case MC_BENCH_THREAD_CREATE:
+    mc_bench_post<MCThreadCreate>(tid,
+                                  MCThreadShadow(nullptr, nullptr, thread));
+    break;
+  case MC_BENCH_THREAD_JOIN:
+    mc_bench_post<MCThreadJoin>(tid,
+                                MCThreadShadow(nullptr, nullptr, thread));
+    break;
+  case MC_BENCH_THREAD_FINISH:
+    mc_bench_post<MCThreadFinish>(
+      tid, MCThreadShadow(nullptr, nullptr, pthread_self()));
+    break;
+  }
+}
+
+/*
+ * Runs the current trace to its end from the given thread, as
+ * `mc_search_dpor_branch_with_thread()` does
+ */
+static uint64_t
+mc_bench_search_branch(tid_t backtrackThread)
+{
+  uint64_t transitions = 0;
+  const MCTransition *nextTransition =
+    &programState->getNextTransitionForThread(backtrackThread);
+  do {
+    const tid_t tid = nextTransition->getThreadId();
+    opsRun[tid]++;
+    mc_bench_post_next_op(tid);
+    transitions++;
+
+    uint64_t begin = mc_bench_now();
+    programState->simulateRunningTransition(
+      *nextTransition, shmTransitionTypeInfo, shmTransitionData);
+    uint64_t end = mc_bench_now();
+    phaseNs[MC_BENCH_SIMULATE] += end - begin;
+    phaseCalls[MC_BENCH_SIMULATE]++;
+
+    begin = end;
+    programState->dynamicallyUpdateBacktrackSets();
+    end = mc_bench_now();
+    phaseNs[MC_BENCH_BACKTRACK] += end - begin;
+    phaseCalls[MC_BENCH_BACKTRACK]++;
+
+    begin = end;
+    programState->hasADataRaceWithNewTransition(
+      programState->getNextTransitionForThread(tid));
+    nextTransition = programState->getFirstEnabledTransition();
+    end            = mc_bench_now();
+    phaseNs[MC_BENCH_CHECKS] += end - begin;
+    phaseCalls[MC_BENCH_CHECKS]++;
+  } while (nextTransition != nullptr);
+  return transitions;
+}
+
+/*
+ * Takes the model back to the given branch point, and the synthetic
+ * threads to where they were at it
+ */
+static tid_t
+mc_bench_backtrack_to(int branchPoint)
+{
+  const tid_t backtrackThread =
+    programState->getStateItemAtIndex(branchPoint).popThreadToBacktrackOn();
+
+  const uint64_t begin = mc_bench_now();
+  programState->reflectStateAtTransitionIndex(branchPoint - 1);
+  phaseNs[MC_BENCH_REFLECT] += mc_bench_now() - begin;
+  phaseCalls[MC_BENCH_REFLECT]++;
+
+  memset(opsRun, 0, sizeof(opsRun));
+  for (int i = 0; i < branchPoint; i++)
+    opsRun[programState->getThreadRunningTransitionAtIndex(i)]++;
+  return backtrackThread;
+}
+
+static void
+mc_bench_usage()
+{
+  fprintf(stderr,
+          "Usage: mcstack_bench [-p mutex|sem|cond|all] [-n <threads>]\n"
+          "                     [-d <depth>] [-o <objects>]"
+          " [-t <max traces>]\n"
+          "                     [-m <max depth per thread>]\n");
+  exit(1);
+}
+
+int
+main(int argc, char *argv[])
+{
+  const char *pattern = "all";
+  int workers         = 3;
+  int depth           = 2;
+  int objects         = 2;
+  uint64_t maxTraces  = 100000;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "p:n:d:o:t:m:h")) != -1) {
+    switch (opt) {
+    case 'p':
+      pattern = optarg;
+      break;
+    case 'n':
+      workers = atoi(optarg);
+      break;
+    case 'd':
+      depth = atoi(optarg);
+      break;
+    case 'o':
+      objects = atoi(optarg);
+      break;
+    case 't':
+      maxTraces = strtoull(optarg, nullptr, 10);
+      break;
+    case 'm':
+      setenv(ENV_MAX_DEPTH_PER_THREAD, optarg, 1);
+      break;
+    default:
+      mc_bench_usage();
+    }
+  }
+  if (workers < 1 || workers >= MC_BENCH_MAX_THREADS || depth < 1 ||
+      objects < 1 || objects > MC_BENCH_MAX_OBJECTS)
+    mc_bench_usage();
+
+  std::vector<std::string> patterns;
+  if (strcmp(pattern, "all") == 0) {
+    patterns = {"mutex", "sem", "cond"};
+  } else if (strcmp(pattern, "mutex") == 0 || strcmp(pattern, "sem") == 0 ||
+             strcmp(pattern, "cond") == 0) {
+    patterns = {pattern};
+  } else {
+    mc_bench_usage();
+  }
+
+  // The mailbox the synthetic threads write into
+  static char mailbox[sizeof(MCSharedTransition) +
+                      MAX_SHARED_MEMORY_ALLOCATION];
+  shmTransitionTypeInfo = (MCSharedTransition *)mailbox;
+  shmTransitionData     = mailbox + sizeof(MCSharedTransition);
+  mc_load_intercepted_symbol_addresses();
+
+  printf("%-6s %7s %5s %7s %8s %11s %9s  %s\n", "", "threads", "depth",
+         "objects", "traces", "transitions", "traces/s", "ns/op");
+  for (const std::string &p : patterns) {
+    mc_bench_build_program(p.c_str(), workers, depth, objects);
+    memset(phaseNs, 0, sizeof(phaseNs));
+    memset(phaseCalls, 0, sizeof(phaseCalls));
+    memset(opsRun, 0, sizeof(opsRun));
+
+    const uint64_t begin = mc_bench_now();
+    mc_create_global_state_object();
+    mc_prepare_to_model_check_new_program();
+    traceId              = 0;
+    uint64_t transitions = mc_bench_search_branch(TID_MAIN_THREAD);
+    uint64_t traces      = 1;
+    int branchPoint      = programState->getDeepestDPORBranchPoint();
+    while (branchPoint != FIRST_BRANCH && traces < maxTraces) {
+      traceId++;
+      transitions +=
+        mc_bench_search_branch(mc_bench_backtrack_to(branchPoint));
+      traces++;
+      branchPoint = programState->getDeepestDPORBranchPoint();
+    }
+    // NOTE: The model of each pattern is left behind (`MCDeferred` has
+    // no way to destroy it other than at exit)
+    const double seconds = (mc_bench_now() - begin) / 1e9;
+
+    printf("%-6s %7d %5d %7d %8lu %11lu %9.0f ", p.c_str(), workers, depth,
+           objects, (unsigned long)traces, (unsigned long)transitions,
+           traces / seconds);
+    for (int i = 0; i < MC_BENCH_PHASE_COUNT; i++) {
+      printf(" %s=%.0f", phaseNames[i],
+             phaseCalls[i] == 0 ? 0.0
+                                : (double)phaseNs[i] / phaseCalls[i]);
+    }
+    printf("%s\n", branchPoint != FIRST_BRANCH ? "  (stopped at -t)" : "");
+  }
+  return 0;
+}
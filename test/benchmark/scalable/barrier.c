@@ -0,0 +1,54 @@
+// THREADS threads go through PHASES phases, each updating a counter
+// under a mutex then waiting at a barrier for the others.
+
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+int DEBUG = 0;
+int PHASES;
+
+pthread_barrier_t barrier;
+pthread_mutex_t mutex;
+int counter = 0;
+
+void * thread_doit(void *num) {
+    for (int i = 0; i < PHASES; i++) {
+        pthread_mutex_lock(&mutex);
+        counter++;
+        pthread_mutex_unlock(&mutex);
+
+        pthread_barrier_wait(&barrier);
+        if(DEBUG)
+            printf("Thread %ld: done with phase %d\n", (long)num, i);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4){
+        printf("Usage: %s NUM_THREADS PHASES DEBUG\n", argv[0]);
+        return 1;
+    }
+
+    int NUM_THREADS = atoi(argv[1]);
+    PHASES = atoi(argv[2]);
+    DEBUG = atoi(argv[3]);
+
+    pthread_t thread[NUM_THREADS];
+    pthread_mutex_init(&mutex, NULL);
+    pthread_barrier_init(&barrier, NULL, NUM_THREADS);
+
+    long i;
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&thread[i], NULL, &thread_doit, (void *)i);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(thread[i], NULL);
+    }
+
+    return 0;
+}
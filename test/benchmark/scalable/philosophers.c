@@ -0,0 +1,69 @@
+// N philosophers around a table, each eating ROUNDS times. Each picks
+// up the lower-numbered of its forks first, so they never deadlock and
+// McMini explores every interleaving of the meals.
+
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+int DEBUG = 0;
+int ROUNDS;
+
+struct forks {
+    int philosopher;
+    pthread_mutex_t *first_fork;
+    pthread_mutex_t *second_fork;
+};
+
+void * philosopher_doit(void *forks_arg) {
+    struct forks *forks = forks_arg;
+    for (int i = 0; i < ROUNDS; i++) {
+        pthread_mutex_lock(forks->first_fork);
+        pthread_mutex_lock(forks->second_fork);
+
+        if(DEBUG)
+            printf("Philosopher %d is eating.\n", forks->philosopher);
+
+        pthread_mutex_unlock(forks->second_fork);
+        pthread_mutex_unlock(forks->first_fork);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4){
+        printf("Usage: %s NUM_PHILOSOPHERS ROUNDS DEBUG\n", argv[0]);
+        return 1;
+    }
+
+    int NUM_THREADS = atoi(argv[1]);
+    ROUNDS = atoi(argv[2]);
+    DEBUG = atoi(argv[3]);
+
+    pthread_t thread[NUM_THREADS];
+    pthread_mutex_t mutex_resource[NUM_THREADS];
+    struct forks forks[NUM_THREADS];
+
+    int i;
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_mutex_init(&mutex_resource[i], NULL);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        int left = i, right = (i+1) % NUM_THREADS;
+        forks[i] = (struct forks){i,
+                                  &mutex_resource[left < right ? left : right],
+                                  &mutex_resource[left < right ? right : left]};
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&thread[i], NULL, &philosopher_doit, &forks[i]);
+    }
+
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(thread[i], NULL);
+    }
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+// PRODUCERS threads each put ITEMS items into a bounded buffer of
+// BUFFER slots, guarded by a mutex and two semaphores, which CONSUMERS
+// threads take out. Once the producers are done, main puts one
+// end-of-work item in the buffer for each consumer.
+
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+
+int DEBUG = 0;
+int ITEMS;
+int BUFFER;
+
+int *buffer;
+int in = 0, out = 0;
+pthread_mutex_t mutex;
+sem_t empty;
+sem_t full;
+
+void put(int item) {
+    sem_wait(&empty);
+    pthread_mutex_lock(&mutex);
+    buffer[in] = item;
+    in = (in + 1) % BUFFER;
+    pthread_mutex_unlock(&mutex);
+    sem_post(&full);
+}
+
+int take() {
+    sem_wait(&full);
+    pthread_mutex_lock(&mutex);
+    int item = buffer[out];
+    out = (out + 1) % BUFFER;
+    pthread_mutex_unlock(&mutex);
+    sem_post(&empty);
+    return item;
+}
+
+void * producer(void *num) {
+    for (int i = 0; i < ITEMS; i++) {
+        put(i);
+        if(DEBUG)
+            printf("Producer %ld: put item %d\n", (long)num, i);
+    }
+    return NULL;
+}
+
+void * consumer(void *num) {
+    int item;
+    while ((item = take()) != -1) {
+        if(DEBUG)
+            printf("Consumer %ld: took item %d\n", (long)num, item);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc != 6){
+        printf("Usage: %s NUM_PRODUCERS NUM_CONSUMERS BUFFER ITEMS DEBUG\n",
+               argv[0]);
+        return 1;
+    }
+
+    int NUM_PRODUCERS = atoi(argv[1]);
+    int NUM_CONSUMERS = atoi(argv[2]);
+    BUFFER = atoi(argv[3]);
+    ITEMS = atoi(argv[4]);
+    DEBUG = atoi(argv[5]);
+
+    int slots[BUFFER];
+    buffer = slots;
+    pthread_t producers[NUM_PRODUCERS];
+    pthread_t consumers[NUM_CONSUMERS];
+
+    pthread_mutex_init(&mutex, NULL);
+    sem_init(&empty, 0, BUFFER);
+    sem_init(&full, 0, 0);
+
+    long i;
+    for (i = 0; i < NUM_PRODUCERS; i++) {
+        pthread_create(&producers[i], NULL, &producer, (void *)i);
+    }
+    for (i = 0; i < NUM_CONSUMERS; i++) {
+        pthread_create(&consumers[i], NULL, &consumer, (void *)i);
+    }
+
+    for (i = 0; i < NUM_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    for (i = 0; i < NUM_CONSUMERS; i++) {
+        put(-1);
+    }
+    for (i = 0; i < NUM_CONSUMERS; i++) {
+        pthread_join(consumers[i], NULL);
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+// READERS and WRITERS threads each take a pthread_rwlock_t ROUNDS times.
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+pthread_rwlock_t rw;
+int DEBUG = 0;
+int ROUNDS;
+
+void *reader(void *notused) {
+    for(int i=0; i< ROUNDS; i++) {
+        pthread_rwlock_rdlock(&rw);
+
+        if (DEBUG) printf("reader is reading\n");
+
+        pthread_rwlock_unlock(&rw);
+    }
+    return NULL;
+}
+
+void *writer(void *notused) {
+    for(int i=0; i< ROUNDS; i++) {
+        pthread_rwlock_wrlock(&rw);
+
+        if (DEBUG) printf("writer is writing\n");
+
+        pthread_rwlock_unlock(&rw);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc != 5){
+        printf("Usage: %s NUM_READERS NUM_WRITERS ROUNDS DEBUG\n", argv[0]);
+        return 1;
+    }
+
+    int NUM_READERS = atoi(argv[1]);
+    int NUM_WRITERS = atoi(argv[2]);
+    ROUNDS = atoi(argv[3]);
+    DEBUG = atoi(argv[4]);
+
+    pthread_t read_thread[NUM_READERS];
+    pthread_t write_thread[NUM_WRITERS];
+    pthread_rwlock_init(&rw, NULL);
+
+    int i;
+    for(i=0; i< NUM_READERS; i++) {
+        pthread_create(&read_thread[i], NULL, reader, NULL);
+    }
+    for(i=0; i< NUM_WRITERS; i++) {
+        pthread_create(&write_thread[i], NULL, writer, NULL);
+    }
+
+    for(i=0; i< NUM_READERS; i++) {
+        pthread_join(read_thread[i], NULL);
+    }
+    for(i=0; i< NUM_WRITERS; i++) {
+        pthread_join(write_thread[i], NULL);
+    }
+
+    return 0;
+}
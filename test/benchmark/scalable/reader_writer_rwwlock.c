@@ -0,0 +1,88 @@
+// READERS, WRITERS1 and WRITERS2 threads each take a pthread_rwwlock_t
+// (the lock with two classes of writers of McMini's export library)
+// ROUNDS times, as a reader or as a writer of the first or second class.
+
+#include "../../program/reader_writer/rwwlock.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+pthread_rwwlock_t rw;
+int DEBUG = 0;
+int ROUNDS;
+
+void *reader(void *notused) {
+    for (int i = 0; i < ROUNDS; i++) {
+        pthread_rwwlock_rdlock(&rw);
+
+        if (DEBUG) printf("reader is reading\n");
+
+        pthread_rwwlock_unlock(&rw);
+    }
+    return NULL;
+}
+
+void *writer1(void *notused) {
+    for (int i = 0; i < ROUNDS; i++) {
+        pthread_rwwlock_wr1lock(&rw);
+
+        if (DEBUG) printf("writer 1 is writing\n");
+
+        pthread_rwwlock_unlock(&rw);
+    }
+    return NULL;
+}
+
+void *writer2(void *notused) {
+    for (int i = 0; i < ROUNDS; i++) {
+        pthread_rwwlock_wr2lock(&rw);
+
+        if (DEBUG) printf("writer 2 is writing\n");
+
+        pthread_rwwlock_unlock(&rw);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 6) {
+        printf("Usage: %s NUM_READERS NUM_WRITERS1 NUM_WRITERS2 ROUNDS DEBUG\n",
+               argv[0]);
+        return 1;
+    }
+
+    int NUM_READERS = atoi(argv[1]);
+    int NUM_WRITERS1 = atoi(argv[2]);
+    int NUM_WRITERS2 = atoi(argv[3]);
+    ROUNDS = atoi(argv[4]);
+    DEBUG = atoi(argv[5]);
+
+    pthread_t read_thread[NUM_READERS];
+    pthread_t write1_thread[NUM_WRITERS1];
+    pthread_t write2_thread[NUM_WRITERS2];
+    pthread_rwwlock_init(&rw);
+
+    int i;
+    for (i = 0; i < NUM_READERS; i++) {
+        pthread_create(&read_thread[i], NULL, reader, NULL);
+    }
+    for (i = 0; i < NUM_WRITERS1; i++) {
+        pthread_create(&write1_thread[i], NULL, writer1, NULL);
+    }
+    for (i = 0; i < NUM_WRITERS2; i++) {
+        pthread_create(&write2_thread[i], NULL, writer2, NULL);
+    }
+
+    for (i = 0; i < NUM_READERS; i++) {
+        pthread_join(read_thread[i], NULL);
+    }
+    for (i = 0; i < NUM_WRITERS1; i++) {
+        pthread_join(write1_thread[i], NULL);
+    }
+    for (i = 0; i < NUM_WRITERS2; i++) {
+        pthread_join(write2_thread[i], NULL);
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+// Every thread but the last crosses the barrier twice; the last one
+// only once, so that the others wait forever in the second phase.
+
+int THREAD_NUM;
+int DEBUG = 0;
+
+pthread_barrier_t barrier;
+pthread_t *thread;
+
+void * thread_doit(void *t)
+{
+    int phases = (*(int*)t == THREAD_NUM - 1) ? 1 : 2;
+    for(int phase = 0; phase < phases; phase++) {
+        if(DEBUG) printf("Thread %d: Waiting at barrier (phase %d)\n",
+                         *(int*)t, phase);
+        pthread_barrier_wait(&barrier);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc != 3){
+        printf("Usage: %s THREAD_NUM DEBUG_FLAG\n", argv[0]);
+        return 1;
+    }
+
+    THREAD_NUM = atoi(argv[1]);
+    DEBUG = atoi(argv[2]);
+
+    thread = (pthread_t*) malloc(THREAD_NUM * sizeof(pthread_t));
+    int *tids = (int*) malloc(THREAD_NUM * sizeof(int));
+
+    pthread_barrier_init(&barrier, NULL, THREAD_NUM);
+    for(int i = 0; i < THREAD_NUM; i++) {
+        tids[i] = i;
+        pthread_create(&thread[i], NULL, &thread_doit, &tids[i]);
+    }
+
+    for(int i = 0; i < THREAD_NUM; i++) {
+        pthread_join(thread[i], NULL);
+    }
+
+    free(thread);
+    free(tids);
+    return 0;
+}
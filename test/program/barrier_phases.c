@@ -0,0 +1,65 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+// Each thread crosses the same barrier PHASES times.  No thread may
+// cross before every thread has arrived in the same phase.
+
+int THREAD_NUM;
+int PHASES;
+int DEBUG;
+
+pthread_barrier_t barrier;
+int *arrived; // The threads which arrived in each phase
+
+void * thread_doit(void *t)
+{
+    int *tid = (int*)t;
+    for(int phase = 0; phase < PHASES; phase++) {
+        __atomic_add_fetch(&arrived[phase], 1, __ATOMIC_SEQ_CST);
+        if(DEBUG) {
+            printf("Thread %d: Waiting at barrier (phase %d)\n", *tid, phase);
+        }
+        pthread_barrier_wait(&barrier);
+        assert(__atomic_load_n(&arrived[phase], __ATOMIC_SEQ_CST) == THREAD_NUM);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 4) {
+        printf("Expected usage: %s THREAD_NUM PHASES DEBUG_FLAG\n", argv[0]);
+        printf("DEBUG_FLAG: 0 - Don't display debug information, 1 - Display debug information\n");
+        return -1;
+    }
+
+    THREAD_NUM = atoi(argv[1]);
+    PHASES = atoi(argv[2]);
+    DEBUG = atoi(argv[3]);
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * THREAD_NUM);
+    int *tids = malloc(sizeof(int) * THREAD_NUM);
+    arrived = calloc(PHASES, sizeof(int));
+
+    pthread_barrier_init(&barrier, NULL, THREAD_NUM);
+
+    for(int i = 0; i < THREAD_NUM; i++) {
+        tids[i] = i;
+        pthread_create(&threads[i], NULL, &thread_doit, &tids[i]);
+    }
+
+    for(int i = 0; i < THREAD_NUM; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    free(tids);
+    free(arrived);
+    pthread_barrier_destroy(&barrier);
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+// Threads that look themselves up by process id after contending on a
+// lock. Each trace McMini explores is a process of its own, and must see
+// its own process id, not that of the trace which first ran the program.
+
+#define _DEFAULT_SOURCE
+#include <assert.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+pthread_mutex_t mutex;
+
+void * thread_doit(void *unused) {
+    pthread_mutex_lock(&mutex);
+    pthread_mutex_unlock(&mutex);
+
+    // The process the id names must be this one, and alive
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)getpid());
+    assert(access(path, R_OK) == 0);
+    assert(kill(getpid(), 0) == 0);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+
+    if(argc < 2) {
+        printf("Expected usage: %s THREAD_NUM\n", argv[0]);
+        return -1;
+    }
+
+    int THREAD_NUM = atoi(argv[1]);
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * THREAD_NUM);
+
+    pthread_mutex_init(&mutex, NULL);
+
+    for(int i = 0; i < THREAD_NUM; i++) {
+        pthread_create(&threads[i], NULL, &thread_doit, NULL);
+    }
+
+    for(int i = 0; i < THREAD_NUM; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    pthread_mutex_destroy(&mutex);
+
+    return 0;
+}
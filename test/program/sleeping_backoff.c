@@ -0,0 +1,90 @@
+// Threads that back off with sleeps between attempts at a lock.
+// Run natively, each run takes a couple of seconds; under McMini, sleeps
+// only advance the virtual clock of the trace, so each trace takes
+// milliseconds (compare with `mcmini --no-virtual-time`).
+
+#define _DEFAULT_SOURCE
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ATTEMPTS 2
+
+pthread_mutex_t mutex;
+int counter = 0;
+
+long elapsed_ms(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 +
+           (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+void * thread_doit(void *unused) {
+    struct timespec start;
+    struct timespec backoff = { 0, 250 * 1000 * 1000 };
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for(int i = 0; i < ATTEMPTS; i++) {
+        pthread_mutex_lock(&mutex);
+        counter++;
+        usleep(100 * 1000);
+        pthread_mutex_unlock(&mutex);
+        nanosleep(&backoff, NULL);
+    }
+    sleep(1);
+
+    // However fast it ran, the thread saw the time it slept go by
+    assert(elapsed_ms(&start) >= ATTEMPTS * 350 + 1000);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+
+    if(argc < 2) {
+        printf("Expected usage: %s THREAD_NUM\n", argv[0]);
+        return -1;
+    }
+
+    int THREAD_NUM = atoi(argv[1]);
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * THREAD_NUM);
+
+    pthread_mutex_init(&mutex, NULL);
+
+    for(int i = 0; i < THREAD_NUM; i++) {
+        pthread_create(&threads[i], NULL, &thread_doit, NULL);
+    }
+
+    for(int i = 0; i < THREAD_NUM; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(counter == THREAD_NUM * ATTEMPTS);
+
+    // A timed wait takes as long as it should however long the threads
+    // slept, whichever clock its deadline and the measure of it are on
+    sem_t never_posted;
+    sem_init(&never_posted, 0, 0);
+    struct timespec start, deadline;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 20 * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    assert(sem_timedwait(&never_posted, &deadline) == -1);
+    assert(errno == ETIMEDOUT);
+    assert(elapsed_ms(&start) >= 20);
+
+    free(threads);
+    pthread_mutex_destroy(&mutex);
+
+    return 0;
+}